@@ -2,6 +2,7 @@
 #define ALGORITHMS_CPP
 
 #include "Graph.cpp"
+#include "Instrumentation.cpp"
 
 namespace graph {
 
@@ -116,6 +117,7 @@ public:
     void insert(int vertex, int prio) {
         if (size == capacity)
             throw "Priority queue is full";
+        GRAPH_COUNT(heapPushes, 1);
         arr[size] = PQNode(vertex, prio);
         pos[vertex] = size;
         size++;
@@ -124,6 +126,7 @@ public:
     int extractMin() {
         if (size == 0)
             throw "Priority queue is empty";
+        GRAPH_COUNT(heapPops, 1);
         int minVertex = arr[0].vertex;
         pos[minVertex] = -1;
         arr[0] = arr[size - 1];
@@ -138,6 +141,7 @@ public:
             throw "Vertex not in priority queue";
         if (newPrio > arr[i].priority)
             throw "New priority is greater than current priority";
+        GRAPH_COUNT(decreaseKeys, 1);
         arr[i].priority = newPrio;
         heapifyUp(i);
     }
@@ -172,6 +176,7 @@ public:
     int find(int x) {
         if (x < 0 || x >= n)
             throw "Index out of range";
+        GRAPH_COUNT(unionFindOps, 1);
         while (parent[x] != x) {
             parent[x] = parent[parent[x]];
             x = parent[x];
@@ -221,20 +226,25 @@ Graph Algorithms::bfs(const Graph& g, int source) {
     int n = g.getNumVertices();
     if (source < 0 || source >= n)
         throw "Source vertex out of range";
+    GRAPH_INSTRUMENT_SCOPE("bfs");
     Graph result(n);
     bool* visited = new bool[n](); // All false
     Queue q;
     visited[source] = true;
     q.enqueue(source);
+    GRAPH_FRONTIER_PUSH();
     // Use a lambda to encapsulate the processing loop.
     auto processQueue = [&]() {
         while (!q.isEmpty()) {
             int cur = q.dequeue();
+            GRAPH_FRONTIER_POP();
             for (Graph::Edge* e = g.getAdjList(cur); e != nullptr; e = e->next) {
+                GRAPH_COUNT(edgesScanned, 1);
                 int nb = e->destination;
                 if (!visited[nb]) {
                     visited[nb] = true;
                     q.enqueue(nb);
+                    GRAPH_FRONTIER_PUSH();
                     result.addEdge(cur, nb, e->weight);
                 }
             }
@@ -250,6 +260,7 @@ Graph Algorithms::dfs(const Graph& g, int source) {
     int n = g.getNumVertices();
     if (source < 0 || source >= n)
         throw "Source vertex out of range";
+    GRAPH_INSTRUMENT_SCOPE("dfs");
     Graph result(n);
     bool* visited = new bool[n](); // All false
     // Define a stack item that holds vertex, parent, and the weight of the edge from parent.
@@ -258,7 +269,9 @@ Graph Algorithms::dfs(const Graph& g, int source) {
         int parent;
         int weight;
     };
-    StackItem* stack = new StackItem[n]; // Maximum n items
+    // A vertex can be pushed once per incident edge, so grow the stack on demand.
+    int capacity = n;
+    StackItem* stack = new StackItem[capacity];
     int top = 0;
     stack[top] = {source, -1, 0};
     while (top >= 0) {
@@ -269,7 +282,16 @@ Graph Algorithms::dfs(const Graph& g, int source) {
                 result.addEdge(curItem.parent, curItem.vertex, curItem.weight);
             // Push neighbors onto the stack.
             for (Graph::Edge* e = g.getAdjList(curItem.vertex); e != nullptr; e = e->next) {
+                GRAPH_COUNT(edgesScanned, 1);
                 if (!visited[e->destination]) {
+                    if (top + 1 == capacity) {
+                        StackItem* bigger = new StackItem[capacity * 2];
+                        for (int i = 0; i <= top; i++)
+                            bigger[i] = stack[i];
+                        delete[] stack;
+                        stack = bigger;
+                        capacity *= 2;
+                    }
                     stack[++top] = {e->destination, curItem.vertex, e->weight};
                 }
             }
@@ -285,6 +307,7 @@ Graph Algorithms::dijkstra(const Graph& g, int source) {
     int n = g.getNumVertices();
     if (source < 0 || source >= n)
         throw "Source vertex out of range";
+    GRAPH_INSTRUMENT_SCOPE("dijkstra");
     Graph result(n);
     int* dist = new int[n];
     int* par = new int[n];
@@ -302,6 +325,7 @@ Graph Algorithms::dijkstra(const Graph& g, int source) {
     while (!pq.isEmpty()) {
         int u = pq.extractMin();
         for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next) {
+            GRAPH_COUNT(edgesScanned, 1);
             int v = e->destination;
             if (pq.inQueue(v) && dist[u] != MAX_INT_VALUE && (dist[u] + e->weight < dist[v])) {
                 dist[v] = dist[u] + e->weight;
@@ -325,6 +349,7 @@ Graph Algorithms::dijkstra(const Graph& g, int source) {
 // --- Prim's Algorithm Implementation ---
 Graph Algorithms::prim(const Graph& g) {
     int n = g.getNumVertices();
+    GRAPH_INSTRUMENT_SCOPE("prim");
     Graph result(n);
     int* key = new int[n];
     int* par = new int[n];
@@ -340,6 +365,7 @@ Graph Algorithms::prim(const Graph& g) {
     while (!pq.isEmpty()) {
         int u = pq.extractMin();
         for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next) {
+            GRAPH_COUNT(edgesScanned, 1);
             int v = e->destination;
             if (pq.inQueue(v) && e->weight < key[v]) {
                 key[v] = e->weight;
@@ -361,6 +387,7 @@ Graph Algorithms::prim(const Graph& g) {
 // --- Kruskal's Algorithm Implementation ---
 Graph Algorithms::kruskal(const Graph& g) {
     int n = g.getNumVertices();
+    GRAPH_INSTRUMENT_SCOPE("kruskal");
     Graph result(n);
     // Define a local structure for edge information.
     struct EdgeInfo {
@@ -372,6 +399,7 @@ Graph Algorithms::kruskal(const Graph& g) {
     // Collect edges, avoiding duplicates in the undirected graph.
     for (int i = 0; i < n; i++) {
         for (Graph::Edge* e = g.getAdjList(i); e != nullptr; e = e->next) {
+            GRAPH_COUNT(edgesScanned, 1);
             if (i < e->destination)
                 edges[count++] = {i, e->destination, e->weight};
         }
@@ -0,0 +1,243 @@
+// CSRGraph.cpp
+#ifndef CSRGRAPH_CPP
+#define CSRGRAPH_CPP
+
+#include "Graph.cpp"
+#include "Parallel.cpp"
+#include <algorithm>
+
+namespace graph {
+
+// Compressed sparse row view of an undirected weighted graph.
+// Every undirected edge {u, v} is stored twice (u -> v and v -> u), so the
+// neighbours of vertex v are targets[offsets[v] .. offsets[v + 1]).
+class CSRGraph {
+public:
+    // Constructors, destructor, and assignment operator.
+    CSRGraph(int vertices, long long entries);
+    ~CSRGraph();
+    CSRGraph(const CSRGraph& other);
+    CSRGraph& operator=(CSRGraph other); // Uses copy-swap idiom.
+    friend void swap(CSRGraph& a, CSRGraph& b);
+
+    // Conversions.
+    static CSRGraph fromGraph(const Graph& g, int threads = 0);
+    // Builds a symmetric CSR from 'count' undirected edges (src[i], dst[i], weight[i]).
+    // Self-loops are dropped; weight may be null (all weights 1).
+    static CSRGraph fromEdges(int vertices, const int* src, const int* dst, const int* weight,
+                              long long count, int threads = 0);
+    Graph toGraph() const;
+
+    // Sorts every neighbour list by (target, weight).
+    void sortNeighbors(int threads = 0);
+
+    // Accessors.
+    int getNumVertices() const;
+    long long getNumEntries() const; // Directed entries, i.e. twice the edge count.
+    long long getNumEdges() const;
+    long long degree(int vertex) const;
+    const long long* getOffsets() const;
+    const int* getTargets() const;
+    const int* getWeights() const;
+
+private:
+    int numVertices;
+    long long numEntries;
+    long long* offsets; // numVertices + 1 row starts.
+    int* targets;
+    int* weights;
+};
+
+// Constructor: allocate the row and entry arrays (rows start empty).
+CSRGraph::CSRGraph(int vertices, long long entries) : numVertices(vertices), numEntries(entries) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    if (entries < 0)
+        throw "Number of entries must be non-negative";
+    offsets = new long long[numVertices + 1]();
+    targets = new int[numEntries];
+    weights = new int[numEntries];
+}
+
+CSRGraph::~CSRGraph() {
+    delete[] offsets;
+    delete[] targets;
+    delete[] weights;
+}
+
+CSRGraph::CSRGraph(const CSRGraph& other) : numVertices(other.numVertices), numEntries(other.numEntries) {
+    offsets = new long long[numVertices + 1];
+    targets = new int[numEntries];
+    weights = new int[numEntries];
+    std::copy(other.offsets, other.offsets + numVertices + 1, offsets);
+    std::copy(other.targets, other.targets + numEntries, targets);
+    std::copy(other.weights, other.weights + numEntries, weights);
+}
+
+void swap(CSRGraph& a, CSRGraph& b) {
+    std::swap(a.numVertices, b.numVertices);
+    std::swap(a.numEntries, b.numEntries);
+    std::swap(a.offsets, b.offsets);
+    std::swap(a.targets, b.targets);
+    std::swap(a.weights, b.weights);
+}
+
+CSRGraph& CSRGraph::operator=(CSRGraph other) {
+    swap(*this, other);
+    return *this;
+}
+
+// fromGraph: count degrees, then copy each adjacency list into its row.
+CSRGraph CSRGraph::fromGraph(const Graph& g, int threads) {
+    int n = g.getNumVertices();
+    long long* deg = new long long[n + 1]();
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++)
+            for (Graph::Edge* e = g.getAdjList(static_cast<int>(v)); e != nullptr; e = e->next)
+                deg[v + 1]++;
+    });
+    for (int v = 0; v < n; v++)
+        deg[v + 1] += deg[v];
+    CSRGraph csr(n, deg[n]);
+    std::copy(deg, deg + n + 1, csr.offsets);
+    delete[] deg;
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            long long pos = csr.offsets[v];
+            for (Graph::Edge* e = g.getAdjList(static_cast<int>(v)); e != nullptr; e = e->next) {
+                csr.targets[pos] = e->destination;
+                csr.weights[pos] = e->weight;
+                pos++;
+            }
+        }
+    });
+    return csr;
+}
+
+// fromEdges: atomic degree count, prefix sum, atomic scatter, then a per-row
+// sort so the result does not depend on the thread interleaving.
+CSRGraph CSRGraph::fromEdges(int vertices, const int* src, const int* dst, const int* weight,
+                             long long count, int threads) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    for (long long i = 0; i < count; i++)
+        if (src[i] < 0 || src[i] >= vertices || dst[i] < 0 || dst[i] >= vertices)
+            throw "Vertex index out of range";
+    std::atomic<long long>* cursor = new std::atomic<long long>[vertices]();
+    Parallel::forRange(0, count, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++) {
+            if (src[i] == dst[i])
+                continue;
+            cursor[src[i]].fetch_add(1, std::memory_order_relaxed);
+            cursor[dst[i]].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    long long total = 0;
+    for (int v = 0; v < vertices; v++)
+        total += cursor[v].load(std::memory_order_relaxed);
+    CSRGraph csr(vertices, total);
+    for (int v = 0; v < vertices; v++) {
+        csr.offsets[v + 1] = csr.offsets[v] + cursor[v].load(std::memory_order_relaxed);
+        cursor[v].store(csr.offsets[v], std::memory_order_relaxed);
+    }
+    Parallel::forRange(0, count, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++) {
+            int u = src[i], v = dst[i];
+            if (u == v)
+                continue;
+            int w = weight ? weight[i] : 1;
+            long long p = cursor[u].fetch_add(1, std::memory_order_relaxed);
+            csr.targets[p] = v;
+            csr.weights[p] = w;
+            p = cursor[v].fetch_add(1, std::memory_order_relaxed);
+            csr.targets[p] = u;
+            csr.weights[p] = w;
+        }
+    });
+    delete[] cursor;
+    csr.sortNeighbors(threads);
+    return csr;
+}
+
+// toGraph: add each undirected edge once (self-loops are stored twice in a row).
+Graph CSRGraph::toGraph() const {
+    Graph g(numVertices);
+    Graph::EdgeTriple* batch = new Graph::EdgeTriple[numEntries / 2 + 1];
+    long long count = 0;
+    for (int u = 0; u < numVertices; u++) {
+        bool skipLoop = false;
+        for (long long i = offsets[u]; i < offsets[u + 1]; i++) {
+            int v = targets[i];
+            if (u < v || (u == v && !skipLoop)) {
+                Graph::EdgeTriple e = {u, v, weights[i]};
+                batch[count++] = e;
+            }
+            if (u == v)
+                skipLoop = !skipLoop;
+        }
+    }
+    g.addEdges(batch, count);
+    delete[] batch;
+    return g;
+}
+
+// sortNeighbors: pack (target, weight) into one key per entry and sort each row.
+void CSRGraph::sortNeighbors(int threads) {
+    Parallel::forDynamic(0, numVertices, 1024, threads, [&](int, long long lo, long long hi) {
+        long long capacity = 0;
+        unsigned long long* keys = 0;
+        for (long long v = lo; v < hi; v++) {
+            long long begin = offsets[v], len = offsets[v + 1] - begin;
+            if (len < 2)
+                continue;
+            if (len > capacity) {
+                delete[] keys;
+                capacity = len;
+                keys = new unsigned long long[capacity];
+            }
+            for (long long i = 0; i < len; i++)
+                keys[i] = (static_cast<unsigned long long>(static_cast<unsigned int>(targets[begin + i])) << 32) |
+                          (static_cast<unsigned int>(weights[begin + i]) ^ 0x80000000u);
+            std::sort(keys, keys + len);
+            for (long long i = 0; i < len; i++) {
+                targets[begin + i] = static_cast<int>(keys[i] >> 32);
+                weights[begin + i] = static_cast<int>(static_cast<unsigned int>(keys[i]) ^ 0x80000000u);
+            }
+        }
+        delete[] keys;
+    });
+}
+
+int CSRGraph::getNumVertices() const {
+    return numVertices;
+}
+
+long long CSRGraph::getNumEntries() const {
+    return numEntries;
+}
+
+long long CSRGraph::getNumEdges() const {
+    return numEntries / 2;
+}
+
+long long CSRGraph::degree(int vertex) const {
+    if (vertex < 0 || vertex >= numVertices)
+        throw "Vertex index out of range";
+    return offsets[vertex + 1] - offsets[vertex];
+}
+
+const long long* CSRGraph::getOffsets() const {
+    return offsets;
+}
+
+const int* CSRGraph::getTargets() const {
+    return targets;
+}
+
+const int* CSRGraph::getWeights() const {
+    return weights;
+}
+
+} // namespace graph
+
+#endif // CSRGRAPH_CPP
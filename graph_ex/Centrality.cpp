@@ -0,0 +1,341 @@
+// Centrality.cpp
+#ifndef CENTRALITY_CPP
+#define CENTRALITY_CPP
+
+#include "Algorithms.cpp"
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include "SpMV.cpp"
+#include <cmath>
+
+namespace graph {
+
+// Vertex centrality measures over a CSRGraph snapshot. Per-vertex results go
+// to caller-provided arrays of getNumVertices() entries.
+class Centrality {
+public:
+    // PageRank with uniform teleport. Dangling (isolated) vertices spread
+    // their rank over the teleport vector. Iterates until the L1 change of
+    // an iteration drops below 'tolerance' or after maxIterations; returns
+    // the number of iterations run. rank sums to 1.
+    static int pageRank(const CSRGraph& g, double* rank, double damping = 0.85, double tolerance = 1e-9,
+                        int maxIterations = 100, int threads = 0);
+    // Personalized PageRank: teleports to the seeds only (uniformly, with
+    // multiplicity), so rank measures proximity to the seed set.
+    static int personalizedPageRank(const CSRGraph& g, const int* seeds, int count, double* rank,
+                                    double damping = 0.85, double tolerance = 1e-9,
+                                    int maxIterations = 100, int threads = 0);
+
+    // Exact betweenness (Brandes): score[v] = sum over unordered pairs {s, t}
+    // not containing v of the fraction of shortest s-t paths through v.
+    // Unweighted paths use BFS; weighted ones use Dijkstra (non-negative
+    // weights). Parallel edges count as distinct paths; self-loops are ignored.
+    static void betweenness(const CSRGraph& g, double* score, bool weighted = false, int threads = 0);
+    // Sampled betweenness (Brandes-Pich): 'samples' sources drawn uniformly
+    // with replacement, scores scaled to estimate the exact values. Returns
+    // an error bound: with probability 'confidence', every score is within
+    // it of the exact value (Hoeffding plus a union bound over the vertices).
+    static double betweennessSampled(const CSRGraph& g, int samples, double* score, unsigned long long seed,
+                                     double confidence = 0.95, bool weighted = false, int threads = 0);
+    // Samples for a bound of epsilon * n (n - 2) / 2, the largest possible score.
+    static int betweennessSamples(int vertices, double epsilon, double confidence = 0.95);
+
+private:
+    // Per-thread state for single-source dependency accumulation.
+    struct Brandes {
+        int* dist;        // -1 when unreached.
+        double* sigma;    // Shortest-path counts.
+        double* delta;    // Dependencies.
+        int* order;       // Vertices in non-decreasing distance.
+        int* position;    // Index in order (weighted only).
+        PriorityQueue* heap;
+        double* total;    // Accumulated dependencies of this thread.
+    };
+    static void brandesRun(const CSRGraph& g, const int* sources, int count, double* score, double scale,
+                           bool weighted, int threads);
+    static void accumulate(const CSRGraph& g, int source, bool weighted, Brandes& b);
+    static int powerIterate(const CSRGraph& g, const double* teleport, double* rank, double damping,
+                            double tolerance, int maxIterations, int threads);
+};
+
+int Centrality::pageRank(const CSRGraph& g, double* rank, double damping, double tolerance,
+                         int maxIterations, int threads) {
+    if (damping < 0 || damping >= 1)
+        throw "Damping factor must be in [0, 1)";
+    int n = g.getNumVertices();
+    double* teleport = new double[n];
+    for (int v = 0; v < n; v++)
+        teleport[v] = 1.0 / n;
+    int iterations = powerIterate(g, teleport, rank, damping, tolerance, maxIterations, threads);
+    delete[] teleport;
+    return iterations;
+}
+
+int Centrality::personalizedPageRank(const CSRGraph& g, const int* seeds, int count, double* rank,
+                                     double damping, double tolerance, int maxIterations, int threads) {
+    if (damping < 0 || damping >= 1)
+        throw "Damping factor must be in [0, 1)";
+    int n = g.getNumVertices();
+    if (count <= 0)
+        throw "At least one seed is required";
+    for (int i = 0; i < count; i++)
+        if (seeds[i] < 0 || seeds[i] >= n)
+            throw "Vertex index out of range";
+    double* teleport = new double[n]();
+    for (int i = 0; i < count; i++)
+        teleport[seeds[i]] += 1.0 / count;
+    int iterations = powerIterate(g, teleport, rank, damping, tolerance, maxIterations, threads);
+    delete[] teleport;
+    return iterations;
+}
+
+// powerIterate: each iteration scales the ranks by the precomputed inverse
+// degrees (contrib) and propagates them with an unmasked pull
+// SpMV::multiply<PlusFirstSemiring>; only the dangling mass, the teleport
+// term and the L1 change are computed here. Per-thread partial sums give the
+// dangling mass and the change without atomics.
+int Centrality::powerIterate(const CSRGraph& g, const double* teleport, double* rank, double damping,
+                             double tolerance, int maxIterations, int threads) {
+    GRAPH_INSTRUMENT_SCOPE("pagerank");
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    threads = Parallel::resolve(threads);
+    double* invDegree = new double[n];
+    double* contrib = new double[n];
+    double* current = rank;
+    double* next = new double[n];
+    double* spare = next;
+    double* partial = new double[threads];
+    int* changed = new int[n > 0 ? n : 1];
+    SpMV::Workspace ws(n > 0 ? n : 1);
+    for (int v = 0; v < n; v++) {
+        long long d = offsets[v + 1] - offsets[v];
+        invDegree[v] = d > 0 ? 1.0 / d : 0.0;
+        rank[v] = teleport[v];
+    }
+    int iteration = 0;
+    while (iteration < maxIterations) {
+        iteration++;
+        for (int t = 0; t < threads; t++)
+            partial[t] = 0;
+        Parallel::forRange(0, n, threads, [&](int t, long long lo, long long hi) {
+            double dangling = 0;
+            for (long long v = lo; v < hi; v++) {
+                contrib[v] = current[v] * invDegree[v];
+                next[v] = 0;
+                if (invDegree[v] == 0)
+                    dangling += current[v];
+            }
+            partial[t] = dangling;
+        });
+        double dangling = 0;
+        for (int t = 0; t < threads; t++) {
+            dangling += partial[t];
+            partial[t] = 0;
+        }
+        SpMV::multiply<PlusFirstSemiring>(g, contrib, 0, 0, next, SpMV::all(), changed, ws, threads, SpMV::Pull);
+        Parallel::forRange(0, n, threads, [&](int t, long long lo, long long hi) {
+            double change = 0;
+            for (long long v = lo; v < hi; v++) {
+                double value = (1 - damping) * teleport[v] + damping * (next[v] + dangling * teleport[v]);
+                change += value > current[v] ? value - current[v] : current[v] - value;
+                next[v] = value;
+            }
+            partial[t] = change;
+        });
+        GRAPH_COUNT(edgesScanned, g.getNumEntries());
+        double change = 0;
+        for (int t = 0; t < threads; t++)
+            change += partial[t];
+        double* swapTmp = current;
+        current = next;
+        next = swapTmp;
+        if (change < tolerance)
+            break;
+    }
+    if (current != rank)
+        std::copy(current, current + n, rank);
+    delete[] invDegree;
+    delete[] contrib;
+    delete[] spare;
+    delete[] partial;
+    delete[] changed;
+    return iteration;
+}
+
+// accumulate: one Brandes pass. The forward search counts shortest paths
+// and records the settle order; the backward pass walks that order in
+// reverse and pulls each vertex's dependency into its predecessors, which
+// are recognised by their distance, so no predecessor lists are stored.
+void Centrality::accumulate(const CSRGraph& g, int source, bool weighted, Brandes& b) {
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    const int* weights = g.getWeights();
+    int reached = 0;
+    b.dist[source] = 0;
+    b.sigma[source] = 1;
+    if (!weighted) {
+        b.order[reached++] = source;
+        for (int head = 0; head < reached; head++) {
+            int u = b.order[head];
+            for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                int v = targets[e];
+                if (b.dist[v] < 0) {
+                    b.dist[v] = b.dist[u] + 1;
+                    b.order[reached++] = v;
+                }
+                if (b.dist[v] == b.dist[u] + 1)
+                    b.sigma[v] += b.sigma[u];
+            }
+        }
+    } else {
+        b.heap->insert(source, 0);
+        while (!b.heap->isEmpty()) {
+            int u = b.heap->extractMin();
+            b.position[u] = reached;
+            b.order[reached++] = u;
+            for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                int v = targets[e];
+                if (v == u || b.position[v] >= 0)
+                    continue;
+                int candidate = b.dist[u] + weights[e];
+                if (b.dist[v] < 0) {
+                    b.dist[v] = candidate;
+                    b.sigma[v] = b.sigma[u];
+                    b.heap->insert(v, candidate);
+                } else if (candidate < b.dist[v]) {
+                    b.dist[v] = candidate;
+                    b.sigma[v] = b.sigma[u];
+                    b.heap->decreaseKey(v, candidate);
+                } else if (candidate == b.dist[v]) {
+                    b.sigma[v] += b.sigma[u];
+                }
+            }
+        }
+    }
+    for (int i = reached - 1; i > 0; i--) {
+        int w = b.order[i];
+        double share = (1 + b.delta[w]) / b.sigma[w];
+        for (long long e = offsets[w]; e < offsets[w + 1]; e++) {
+            int v = targets[e];
+            bool predecessor = weighted
+                ? b.position[v] >= 0 && b.position[v] < b.position[w] && b.dist[v] + weights[e] == b.dist[w]
+                : b.dist[v] == b.dist[w] - 1;
+            if (predecessor)
+                b.delta[v] += b.sigma[v] * share;
+        }
+        b.total[w] += b.delta[w];
+    }
+    for (int i = 0; i < reached; i++) {
+        int v = b.order[i];
+        b.dist[v] = -1;
+        b.sigma[v] = 0;
+        b.delta[v] = 0;
+        if (weighted)
+            b.position[v] = -1;
+    }
+}
+
+// brandesRun: sources are handed out one at a time; each thread owns its
+// Brandes state and dependency totals, which are summed per vertex at the end.
+void Centrality::brandesRun(const CSRGraph& g, const int* sources, int count, double* score, double scale,
+                            bool weighted, int threads) {
+    GRAPH_INSTRUMENT_SCOPE("betweenness");
+    int n = g.getNumVertices();
+    if (weighted)
+        for (long long e = 0; e < g.getNumEntries(); e++)
+            if (g.getWeights()[e] < 0)
+                throw "Negative edge weight";
+    threads = Parallel::resolve(threads);
+    if (threads > count)
+        threads = count > 0 ? count : 1;
+    Brandes* states = new Brandes[threads];
+    for (int t = 0; t < threads; t++) {
+        Brandes& b = states[t];
+        b.dist = new int[n];
+        b.sigma = new double[n]();
+        b.delta = new double[n]();
+        b.order = new int[n];
+        b.position = weighted ? new int[n] : 0;
+        b.heap = weighted ? new PriorityQueue(n) : 0;
+        b.total = new double[n]();
+        for (int v = 0; v < n; v++) {
+            b.dist[v] = -1;
+            if (weighted)
+                b.position[v] = -1;
+        }
+    }
+    Parallel::forDynamic(0, count, 1, threads, [&](int t, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++)
+            accumulate(g, sources[i], weighted, states[t]);
+    });
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            double sum = 0;
+            for (int t = 0; t < threads; t++)
+                sum += states[t].total[v];
+            score[v] = sum * scale;
+        }
+    });
+    for (int t = 0; t < threads; t++) {
+        Brandes& b = states[t];
+        delete[] b.dist;
+        delete[] b.sigma;
+        delete[] b.delta;
+        delete[] b.order;
+        delete[] b.position;
+        delete b.heap;
+        delete[] b.total;
+    }
+    delete[] states;
+}
+
+// Every unordered pair is counted from both of its ends, hence the halving.
+void Centrality::betweenness(const CSRGraph& g, double* score, bool weighted, int threads) {
+    int n = g.getNumVertices();
+    int* sources = new int[n];
+    for (int v = 0; v < n; v++)
+        sources[v] = v;
+    brandesRun(g, sources, n, score, 0.5, weighted, threads);
+    delete[] sources;
+}
+
+// betweennessSampled: each sample n * delta_s(v) / 2 is an unbiased estimate
+// of score[v] and lies in [0, n (n - 2) / 2], so Hoeffding's inequality over
+// the n vertices gives the bound. Sources are drawn up front from a SplitMix64
+// stream, so the estimate does not depend on the thread count.
+double Centrality::betweennessSampled(const CSRGraph& g, int samples, double* score, unsigned long long seed,
+                                      double confidence, bool weighted, int threads) {
+    if (samples <= 0)
+        throw "At least one sample is required";
+    if (confidence <= 0 || confidence >= 1)
+        throw "Confidence must be in (0, 1)";
+    int n = g.getNumVertices();
+    int* sources = new int[samples];
+    unsigned long long state = seed;
+    for (int i = 0; i < samples; i++) {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        sources[i] = static_cast<int>((z ^ (z >> 31)) % static_cast<unsigned long long>(n));
+    }
+    brandesRun(g, sources, samples, score, 0.5 * n / samples, weighted, threads);
+    delete[] sources;
+    double range = 0.5 * n * (n > 2 ? n - 2 : 0);
+    return range * std::sqrt(std::log(2.0 * n / (1 - confidence)) / (2.0 * samples));
+}
+
+int Centrality::betweennessSamples(int vertices, double epsilon, double confidence) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    if (epsilon <= 0)
+        throw "Epsilon must be positive";
+    if (confidence <= 0 || confidence >= 1)
+        throw "Confidence must be in (0, 1)";
+    return static_cast<int>(std::ceil(std::log(2.0 * vertices / (1 - confidence)) / (2 * epsilon * epsilon)));
+}
+
+} // namespace graph
+
+#endif // CENTRALITY_CPP
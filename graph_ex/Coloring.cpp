@@ -0,0 +1,288 @@
+// Coloring.cpp
+#ifndef COLORING_CPP
+#define COLORING_CPP
+
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <atomic>
+
+namespace graph {
+
+// Greedy vertex colouring: color[v] in 0 .. count - 1 with adjacent vertices
+// coloured differently; the calls return count. Self-loops are ignored.
+// No vertex gets a colour above its degree.
+class Coloring {
+public:
+    // Order in which vertices claim colours: by id (JP: random priorities),
+    // or by decreasing degree, which usually needs fewer colours.
+    enum Ordering { Natural, LargestFirst };
+
+    // Speculative greedy: all pending vertices pick colours in parallel from
+    // the colours their neighbours hold at the time, then conflicts are
+    // detected and the later vertex of each conflicting pair retries.
+    static int speculative(const CSRGraph& g, int* color, Ordering ordering = Natural, int threads = 0);
+    static int speculative(const Graph& g, int* color, Ordering ordering = Natural, int threads = 0);
+    // Repairs a colouring in place, e.g. after edges were added: vertices
+    // coloured -1 or above their degree, and those sharing a colour with a
+    // neighbour earlier in the order, are recoloured speculatively; every
+    // other vertex keeps its colour. Colours below -1 throw.
+    static int recolor(const CSRGraph& g, int* color, Ordering ordering = Natural, int threads = 0);
+    // Jones-Plassmann: a vertex is coloured once every neighbour of higher
+    // priority is. The result depends only on the seed, not on the threads.
+    static int jonesPlassmann(const CSRGraph& g, int* color, Ordering ordering = Natural,
+                              unsigned long long seed = 1, int threads = 0);
+    static int jonesPlassmann(const Graph& g, int* color, Ordering ordering = Natural,
+                              unsigned long long seed = 1, int threads = 0);
+    // Whether no edge joins two vertices of the same colour.
+    static bool isProper(const CSRGraph& g, const int* color);
+
+private:
+    // rank[v] = position of v in the colouring order (0 first).
+    static void rankVertices(const CSRGraph& g, Ordering ordering, unsigned long long seed, bool shuffle,
+                             int* rank, int threads);
+    static unsigned long long mix(unsigned long long seed, unsigned long long v);
+};
+
+// mix: SplitMix64 finaliser of (seed, v), for random priorities.
+unsigned long long Coloring::mix(unsigned long long seed, unsigned long long v) {
+    unsigned long long z = seed + (v + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// rankVertices: sorts keys of (major, noise, vertex). Major is the negated
+// degree for LargestFirst, or random when shuffling a Natural order; noise
+// breaks degree ties randomly when shuffling.
+void Coloring::rankVertices(const CSRGraph& g, Ordering ordering, unsigned long long seed, bool shuffle,
+                            int* rank, int threads) {
+    int n = g.getNumVertices();
+    if (ordering == Natural && !shuffle) {
+        for (int v = 0; v < n; v++)
+            rank[v] = v;
+        return;
+    }
+    // Top 20 bits: major (degree capped at 2^20 - 1); then 12 bits of noise; then the id.
+    unsigned long long* keys = new unsigned long long[n];
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            unsigned long long major = 0;
+            if (ordering == LargestFirst) {
+                long long d = g.degree(static_cast<int>(v));
+                major = (1ULL << 20) - 1 - static_cast<unsigned long long>(d < (1LL << 20) ? d : (1LL << 20) - 1);
+            } else {
+                major = mix(seed ^ 0x5555555555555555ULL, v) >> 44;
+            }
+            unsigned long long noise = shuffle ? mix(seed, v) & 0xFFFULL : 0;
+            keys[v] = (major << 44) | (noise << 32) | static_cast<unsigned long long>(v);
+        }
+    });
+    Parallel::sort(keys, n, threads);
+    for (int r = 0; r < n; r++)
+        rank[keys[r] & 0xFFFFFFFFULL] = r;
+    delete[] keys;
+}
+
+int Coloring::speculative(const CSRGraph& g, int* color, Ordering ordering, int threads) {
+    for (int v = 0; v < g.getNumVertices(); v++)
+        color[v] = -1;
+    return recolor(g, color, ordering, threads);
+}
+
+// recolor: rounds over a shrinking worklist, which starts as the vertices to
+// repair in rank order. Each thread marks the colours it sees around a vertex
+// in its own stamp array (indexed by colour) with a per-thread visit count,
+// so marks left by an earlier visit, even of the same vertex in an earlier
+// round, never count; the vertex takes the first unmarked colour. Detection
+// re-reads the colours; a vertex whose neighbour of lower rank shares its
+// colour goes to the next round. Kept vertices never change and pending ones
+// read them, so each round finalises at least the pending vertex of lowest
+// rank.
+int Coloring::recolor(const CSRGraph& g, int* color, Ordering ordering, int threads) {
+    int n = g.getNumVertices();
+    for (int v = 0; v < n; v++)
+        if (color[v] < -1)
+            throw "Colours must be -1 or non-negative";
+    GRAPH_INSTRUMENT_SCOPE("coloring_speculative");
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    threads = Parallel::resolve(threads);
+    int* rank = new int[n];
+    rankVertices(g, ordering, 0, false, rank, threads);
+    long long maxDegree = 0;
+    for (int v = 0; v < n; v++)
+        if (g.degree(v) > maxDegree)
+            maxDegree = g.degree(v);
+    std::atomic<int>* colors = new std::atomic<int>[n];
+    int* work = new int[n];
+    int* retry = new int[n];
+    for (int v = 0; v < n; v++) {
+        colors[v].store(color[v] > g.degree(v) ? -1 : color[v], std::memory_order_relaxed);
+        retry[rank[v]] = v;
+    }
+    // Whether v, coloured c, clashes with a neighbour of lower rank.
+    auto clashes = [&](int v, int c) {
+        for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+            int w = targets[e];
+            if (w != v && rank[w] < rank[v] && colors[w].load(std::memory_order_relaxed) == c)
+                return true;
+        }
+        return false;
+    };
+    long long workSize = 0;
+    for (int r = 0; r < n; r++) {
+        int v = retry[r];
+        int c = colors[v].load(std::memory_order_relaxed);
+        if (c < 0 || clashes(v, c))
+            work[workSize++] = v;
+    }
+    long long** stamp = new long long*[threads];
+    long long* visits = new long long[threads]();
+    for (int t = 0; t < threads; t++)
+        stamp[t] = new long long[maxDegree + 1]();
+    while (workSize > 0) {
+        Parallel::forDynamic(0, workSize, 256, threads, [&](int t, long long lo, long long hi) {
+            long long* seen = stamp[t];
+            for (long long i = lo; i < hi; i++) {
+                int v = work[i];
+                long long mark = ++visits[t];
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+                    int c = colors[targets[e]].load(std::memory_order_relaxed);
+                    if (c >= 0 && c <= maxDegree && targets[e] != v)
+                        seen[c] = mark;
+                }
+                int c = 0;
+                while (seen[c] == mark)
+                    c++;
+                colors[v].store(c, std::memory_order_relaxed);
+            }
+        });
+        std::atomic<long long> retrySize(0);
+        Parallel::forDynamic(0, workSize, 256, threads, [&](int, long long lo, long long hi) {
+            for (long long i = lo; i < hi; i++) {
+                int v = work[i];
+                if (clashes(v, colors[v].load(std::memory_order_relaxed)))
+                    retry[retrySize.fetch_add(1, std::memory_order_relaxed)] = v;
+            }
+        });
+        GRAPH_COUNT(edgesScanned, 2 * g.getNumEntries());
+        workSize = retrySize.load();
+        std::swap(work, retry);
+    }
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        color[v] = colors[v].load(std::memory_order_relaxed);
+        if (color[v] + 1 > count)
+            count = color[v] + 1;
+    }
+    for (int t = 0; t < threads; t++)
+        delete[] stamp[t];
+    delete[] stamp;
+    delete[] visits;
+    delete[] rank;
+    delete[] colors;
+    delete[] work;
+    delete[] retry;
+    return count;
+}
+
+int Coloring::speculative(const Graph& g, int* color, Ordering ordering, int threads) {
+    return speculative(CSRGraph::fromGraph(g, threads), color, ordering, threads);
+}
+
+// jonesPlassmann: each vertex counts its neighbours of higher priority
+// (lower rank). Vertices with none form the first frontier; colouring a
+// vertex decrements its lower-priority neighbours, and those reaching zero
+// form the next. A vertex only reads colours of neighbours that finished in
+// earlier rounds, so O(V + E) work and no races on the colours.
+int Coloring::jonesPlassmann(const CSRGraph& g, int* color, Ordering ordering, unsigned long long seed,
+                             int threads) {
+    GRAPH_INSTRUMENT_SCOPE("coloring_jones_plassmann");
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    threads = Parallel::resolve(threads);
+    int* rank = new int[n];
+    rankVertices(g, ordering, seed, true, rank, threads);
+    long long maxDegree = 0;
+    for (int v = 0; v < n; v++)
+        if (g.degree(v) > maxDegree)
+            maxDegree = g.degree(v);
+    std::atomic<int>* waiting = new std::atomic<int>[n];
+    int* frontier = new int[n];
+    int* next = new int[n];
+    std::atomic<long long> frontierSize(0);
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            int before = 0;
+            for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+                if (rank[targets[e]] < rank[v])
+                    before++;
+            waiting[v].store(before, std::memory_order_relaxed);
+            if (before == 0)
+                frontier[frontierSize.fetch_add(1, std::memory_order_relaxed)] = static_cast<int>(v);
+        }
+    });
+    int** stamp = new int*[threads];
+    for (int t = 0; t < threads; t++) {
+        stamp[t] = new int[maxDegree + 1];
+        for (long long c = 0; c <= maxDegree; c++)
+            stamp[t][c] = -1;
+    }
+    long long size = frontierSize.load();
+    while (size > 0) {
+        std::atomic<long long> nextSize(0);
+        Parallel::forDynamic(0, size, 256, threads, [&](int t, long long lo, long long hi) {
+            int* seen = stamp[t];
+            for (long long i = lo; i < hi; i++) {
+                int v = frontier[i];
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+                    if (rank[targets[e]] < rank[v] && color[targets[e]] <= maxDegree)
+                        seen[color[targets[e]]] = v;
+                int c = 0;
+                while (seen[c] == v)
+                    c++;
+                color[v] = c;
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+                    int w = targets[e];
+                    if (rank[w] > rank[v] && waiting[w].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        next[nextSize.fetch_add(1, std::memory_order_relaxed)] = w;
+                }
+            }
+        });
+        size = nextSize.load();
+        std::swap(frontier, next);
+    }
+    GRAPH_COUNT(edgesScanned, 3 * g.getNumEntries());
+    int count = 0;
+    for (int v = 0; v < n; v++)
+        if (color[v] + 1 > count)
+            count = color[v] + 1;
+    for (int t = 0; t < threads; t++)
+        delete[] stamp[t];
+    delete[] stamp;
+    delete[] rank;
+    delete[] waiting;
+    delete[] frontier;
+    delete[] next;
+    return count;
+}
+
+int Coloring::jonesPlassmann(const Graph& g, int* color, Ordering ordering, unsigned long long seed, int threads) {
+    return jonesPlassmann(CSRGraph::fromGraph(g, threads), color, ordering, seed, threads);
+}
+
+bool Coloring::isProper(const CSRGraph& g, const int* color) {
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    for (int v = 0; v < g.getNumVertices(); v++)
+        for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+            if (targets[e] != v && color[targets[e]] == color[v])
+                return false;
+    return true;
+}
+
+} // namespace graph
+
+#endif // COLORING_CPP
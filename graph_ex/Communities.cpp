@@ -0,0 +1,518 @@
+// Communities.cpp
+#ifndef COMMUNITIES_CPP
+#define COMMUNITIES_CPP
+
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <atomic>
+
+namespace graph {
+
+// Community detection. Results are per-vertex community ids, numbered
+// 0 .. count - 1 in order of each community's lowest vertex; the calls
+// return count. Edge weights count as multiplicities, and a self-loop adds
+// twice its weight to its vertex's degree, as in Graph.
+class Communities {
+public:
+    // Asynchronous label propagation: each vertex repeatedly takes the label
+    // of greatest total edge weight among its neighbours, reading the labels
+    // as other threads update them. Stops when a sweep changes nothing or
+    // after maxIterations sweeps.
+    static int labelPropagation(const CSRGraph& g, int* community, int maxIterations = 20,
+                                unsigned long long seed = 1, int threads = 0);
+    static int labelPropagation(const Graph& g, int* community, int maxIterations = 20,
+                                unsigned long long seed = 1, int threads = 0);
+    // Louvain modularity optimisation with parallel local moving and graph
+    // contraction between levels. Non-negative weights only.
+    static int louvain(const CSRGraph& g, int* community, double resolution = 1.0, int threads = 0);
+    static int louvain(const Graph& g, int* community, double resolution = 1.0, int threads = 0);
+    // Modularity of a partition with ids in [0, n); 0 for a graph without edges.
+    static double modularity(const CSRGraph& g, const int* community, double resolution = 1.0);
+
+    // Local moving stops once a sweep gains less modularity than this.
+    static const double MinGain;
+    static const int MaxSweeps = 64;
+
+private:
+    // One level of Louvain: a symmetric weighted CSR whose self-loop entries
+    // hold the internal weight of a contracted community.
+    struct Level {
+        int numVertices;
+        long long* offsets;
+        int* targets;
+        long long* weights;
+    };
+    // Per-thread scratch that sums edge weights by label. Open addressing
+    // over a power-of-two table kept at most a quarter full, so its size
+    // follows the largest degree rather than the number of vertices. Each
+    // vertex probes only the prefix its own degree needs, which keeps the
+    // many low-degree vertices in cache. When the table would cover every
+    // key anyway, keys index it directly.
+    struct WeightMap {
+        int* keys;         // -1 marks a free slot.
+        long long* values;
+        int* used;         // Occupied slots in insertion order.
+        int numUsed;
+        int shift;         // Slots are the top bits of a multiplicative hash.
+        int mask;
+        bool direct;       // Slot == key; no hashing or probing.
+
+        // Keys lie in [0, keyRange); at most maxKeys are present at once.
+        WeightMap(long long maxKeys, int keyRange) : numUsed(0), direct(false) {
+            prepare(maxKeys);
+            long long slots = mask + 1LL;
+            if (slots >= keyRange) {
+                direct = true;
+                slots = keyRange > 0 ? keyRange : 1;
+            }
+            keys = new int[slots];
+            values = new long long[slots];
+            used = new int[slots];
+            for (long long i = 0; i < slots; i++)
+                keys[i] = -1;
+        }
+        ~WeightMap() {
+            delete[] keys;
+            delete[] values;
+            delete[] used;
+        }
+        // Sizes the probed prefix for up to maxKeys keys; the map must be empty.
+        void prepare(long long maxKeys) {
+            if (direct)
+                return;
+            shift = 31;
+            mask = 1;
+            while (mask + 1 < 4 * maxKeys) {
+                mask = mask * 2 + 1;
+                shift--;
+            }
+        }
+        // Slot holding key, or -1.
+        int find(int key) const {
+            if (direct)
+                return keys[key] == key ? key : -1;
+            int slot = static_cast<int>((static_cast<unsigned>(key) * 2654435761u) >> shift);
+            while (keys[slot] != key) {
+                if (keys[slot] < 0)
+                    return -1;
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+        // Slot holding key, added with value 0 if absent.
+        int insert(int key) {
+            int slot = direct ? key : static_cast<int>((static_cast<unsigned>(key) * 2654435761u) >> shift);
+            while (keys[slot] != key) {
+                if (keys[slot] < 0) {
+                    keys[slot] = key;
+                    values[slot] = 0;
+                    used[numUsed++] = slot;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+        void clear() {
+            for (int k = 0; k < numUsed; k++)
+                keys[used[k]] = -1;
+            numUsed = 0;
+        }
+
+    private:
+        WeightMap(const WeightMap&);
+        WeightMap& operator=(const WeightMap&);
+    };
+    static long long maxDegree(const long long* offsets, int n);
+    static void release(Level& level);
+    static bool moveLocal(const Level& level, int* assign, double resolution, double totalWeight, int threads);
+    static Level contract(const Level& level, const int* assign, int count, int threads);
+    static int renumber(int* ids, int n);
+};
+
+const double Communities::MinGain = 1e-7;
+
+long long Communities::maxDegree(const long long* offsets, int n) {
+    long long most = 0;
+    for (int v = 0; v < n; v++)
+        if (offsets[v + 1] - offsets[v] > most)
+            most = offsets[v + 1] - offsets[v];
+    return most;
+}
+
+// renumber: ids become 0 .. count - 1 in order of first appearance.
+int Communities::renumber(int* ids, int n) {
+    int* remap = new int[n];
+    for (int v = 0; v < n; v++)
+        remap[v] = -1;
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        if (remap[ids[v]] < 0)
+            remap[ids[v]] = count++;
+        ids[v] = remap[ids[v]];
+    }
+    delete[] remap;
+    return count;
+}
+
+// labelPropagation: vertices are visited in one shuffled order, split into
+// blocks handed out dynamically. Each thread tallies neighbour labels in its
+// own WeightMap, clearing only the slots it used. Ties keep the current
+// label, then prefer the smallest.
+int Communities::labelPropagation(const CSRGraph& g, int* community, int maxIterations,
+                                  unsigned long long seed, int threads) {
+    GRAPH_INSTRUMENT_SCOPE("label_propagation");
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    const int* weights = g.getWeights();
+    threads = Parallel::resolve(threads);
+    std::atomic<int>* label = new std::atomic<int>[n];
+    int* order = new int[n];
+    for (int v = 0; v < n; v++) {
+        label[v].store(v, std::memory_order_relaxed);
+        order[v] = v;
+    }
+    unsigned long long state = seed;
+    for (int i = n - 1; i > 0; i--) {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        int j = static_cast<int>((z ^ (z >> 31)) % static_cast<unsigned long long>(i + 1));
+        std::swap(order[i], order[j]);
+    }
+    long long widest = maxDegree(offsets, n);
+    WeightMap** tallies = new WeightMap*[threads];
+    for (int t = 0; t < threads; t++)
+        tallies[t] = new WeightMap(widest, n);
+    for (int iteration = 0; iteration < maxIterations; iteration++) {
+        std::atomic<long long> changes(0);
+        Parallel::forDynamic(0, n, 256, threads, [&](int t, long long lo, long long hi) {
+            WeightMap& tally = *tallies[t];
+            long long local = 0;
+            for (long long i = lo; i < hi; i++) {
+                int v = order[i];
+                tally.prepare(offsets[v + 1] - offsets[v]);
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+                    if (targets[e] == v)
+                        continue;
+                    tally.values[tally.insert(label[targets[e]].load(std::memory_order_relaxed))] += weights[e];
+                }
+                int current = label[v].load(std::memory_order_relaxed);
+                int best = current;
+                int own = tally.find(current);
+                long long bestScore = own >= 0 ? tally.values[own] : 0;
+                for (int k = 0; k < tally.numUsed; k++) {
+                    int l = tally.keys[tally.used[k]];
+                    long long score = tally.values[tally.used[k]];
+                    if (score > bestScore || (score == bestScore && best != current && l < best)) {
+                        best = l;
+                        bestScore = score;
+                    }
+                }
+                tally.clear();
+                if (best != current) {
+                    label[v].store(best, std::memory_order_relaxed);
+                    local++;
+                }
+            }
+            changes.fetch_add(local, std::memory_order_relaxed);
+        });
+        GRAPH_COUNT(edgesScanned, g.getNumEntries());
+        if (changes.load() == 0)
+            break;
+    }
+    for (int v = 0; v < n; v++)
+        community[v] = label[v].load(std::memory_order_relaxed);
+    for (int t = 0; t < threads; t++)
+        delete tallies[t];
+    delete[] tallies;
+    delete[] label;
+    delete[] order;
+    return renumber(community, n);
+}
+
+int Communities::labelPropagation(const Graph& g, int* community, int maxIterations,
+                                  unsigned long long seed, int threads) {
+    return labelPropagation(CSRGraph::fromGraph(g, threads), community, maxIterations, seed, threads);
+}
+
+void Communities::release(Level& level) {
+    delete[] level.offsets;
+    delete[] level.targets;
+    delete[] level.weights;
+}
+
+// moveLocal: sweeps over the vertices in parallel. A vertex joins the
+// neighbouring community with the largest modularity gain, provided it beats
+// staying; community totals and sizes are atomics shared by all threads.
+// Two singletons only merge towards the lower id, which stops neighbouring
+// singletons from swapping forever. Returns whether any vertex moved.
+bool Communities::moveLocal(const Level& level, int* assign, double resolution, double totalWeight,
+                            int threads) {
+    int n = level.numVertices;
+    const long long* offsets = level.offsets;
+    const int* targets = level.targets;
+    const long long* weights = level.weights;
+    threads = Parallel::resolve(threads);
+    std::atomic<int>* comm = new std::atomic<int>[n];
+    std::atomic<long long>* total = new std::atomic<long long>[n];
+    std::atomic<int>* size = new std::atomic<int>[n];
+    long long* degree = new long long[n];
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            long long d = 0;
+            for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+                d += weights[e];
+            degree[v] = d;
+            comm[v].store(static_cast<int>(v), std::memory_order_relaxed);
+            total[v].store(d, std::memory_order_relaxed);
+            size[v].store(1, std::memory_order_relaxed);
+        }
+    });
+    long long widest = maxDegree(offsets, n) + 1; // Neighbours' communities and its own.
+    WeightMap** links = new WeightMap*[threads];
+    for (int t = 0; t < threads; t++)
+        links[t] = new WeightMap(widest, n);
+    double* partial = new double[threads](); // forRange may use fewer threads.
+    bool moved = false;
+    double previous = -1;
+    for (int sweep = 0; sweep < MaxSweeps; sweep++) {
+        std::atomic<long long> moves(0);
+        Parallel::forDynamic(0, n, 256, threads, [&](int t, long long lo, long long hi) {
+            WeightMap& weightTo = *links[t];
+            long long local = 0;
+            for (long long v = lo; v < hi; v++) {
+                int current = comm[v].load(std::memory_order_relaxed);
+                weightTo.prepare(offsets[v + 1] - offsets[v] + 1);
+                int own = weightTo.insert(current); // Always the first slot used.
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+                    if (targets[e] == v)
+                        continue;
+                    weightTo.values[weightTo.insert(comm[targets[e]].load(std::memory_order_relaxed))] += weights[e];
+                }
+                double scale = resolution * degree[v] / totalWeight;
+                int best = current;
+                double bestGain = weightTo.values[own] - scale * (total[current].load(std::memory_order_relaxed) - degree[v]);
+                for (int k = 1; k < weightTo.numUsed; k++) {
+                    int c = weightTo.keys[weightTo.used[k]];
+                    double gain = weightTo.values[weightTo.used[k]] - scale * total[c].load(std::memory_order_relaxed);
+                    if (gain > bestGain || (gain == bestGain && best != current && c < best)) {
+                        best = c;
+                        bestGain = gain;
+                    }
+                }
+                weightTo.clear();
+                if (best == current)
+                    continue;
+                if (size[current].load(std::memory_order_relaxed) == 1 &&
+                    size[best].load(std::memory_order_relaxed) == 1 && best > current)
+                    continue;
+                total[current].fetch_sub(degree[v], std::memory_order_relaxed);
+                total[best].fetch_add(degree[v], std::memory_order_relaxed);
+                size[current].fetch_sub(1, std::memory_order_relaxed);
+                size[best].fetch_add(1, std::memory_order_relaxed);
+                comm[v].store(best, std::memory_order_relaxed);
+                local++;
+            }
+            moves.fetch_add(local, std::memory_order_relaxed);
+        });
+        if (moves.load() == 0)
+            break;
+        moved = true;
+        // Modularity after the sweep: internal weight minus the expected one.
+        Parallel::forRange(0, n, threads, [&](int t, long long lo, long long hi) {
+            double sum = 0;
+            for (long long v = lo; v < hi; v++) {
+                int c = comm[v].load(std::memory_order_relaxed);
+                long long inside = 0;
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+                    if (comm[targets[e]].load(std::memory_order_relaxed) == c)
+                        inside += weights[e];
+                double share = total[v].load(std::memory_order_relaxed) / totalWeight;
+                sum += inside / totalWeight - resolution * share * share;
+            }
+            partial[t] = sum;
+        });
+        double quality = 0;
+        for (int t = 0; t < threads; t++)
+            quality += partial[t];
+        if (sweep > 0 && quality - previous < MinGain)
+            break;
+        previous = quality;
+    }
+    for (int v = 0; v < n; v++)
+        assign[v] = comm[v].load(std::memory_order_relaxed);
+    for (int t = 0; t < threads; t++)
+        delete links[t];
+    delete[] links;
+    delete[] partial;
+    delete[] comm;
+    delete[] total;
+    delete[] size;
+    delete[] degree;
+    return moved;
+}
+
+// contract: one vertex per community. Members are grouped by a counting
+// sort; each community's row is built twice in parallel (sizes, then
+// entries) with per-thread accumulators indexed by neighbour community.
+Communities::Level Communities::contract(const Level& level, const int* assign, int count, int threads) {
+    int n = level.numVertices;
+    threads = Parallel::resolve(threads);
+    int* memberStart = new int[count + 1]();
+    int* members = new int[n];
+    for (int v = 0; v < n; v++)
+        memberStart[assign[v] + 1]++;
+    for (int c = 0; c < count; c++)
+        memberStart[c + 1] += memberStart[c];
+    int* fill = new int[count];
+    std::copy(memberStart, memberStart + count, fill);
+    for (int v = 0; v < n; v++)
+        members[fill[assign[v]]++] = v;
+    delete[] fill;
+    int** stamp = new int*[threads];
+    long long** sum = new long long*[threads];
+    int** list = new int*[threads];
+    for (int t = 0; t < threads; t++) {
+        stamp[t] = new int[count];
+        sum[t] = new long long[count];
+        list[t] = new int[count];
+        for (int c = 0; c < count; c++)
+            stamp[t][c] = -1;
+    }
+    Level next;
+    next.numVertices = count;
+    next.offsets = new long long[count + 1];
+    next.offsets[0] = 0;
+    // Gathers row c into list[t][0 .. size) and sum[t]; returns size.
+    auto gather = [&](int t, int c) {
+        int size = 0;
+        for (int i = memberStart[c]; i < memberStart[c + 1]; i++) {
+            int v = members[i];
+            for (long long e = level.offsets[v]; e < level.offsets[v + 1]; e++) {
+                int d = assign[level.targets[e]];
+                if (stamp[t][d] != c) {
+                    stamp[t][d] = c;
+                    sum[t][d] = 0;
+                    list[t][size++] = d;
+                }
+                sum[t][d] += level.weights[e];
+            }
+        }
+        return size;
+    };
+    Parallel::forDynamic(0, count, 64, threads, [&](int t, long long lo, long long hi) {
+        for (long long c = lo; c < hi; c++)
+            next.offsets[c + 1] = gather(t, static_cast<int>(c));
+    });
+    for (int c = 0; c < count; c++)
+        next.offsets[c + 1] += next.offsets[c];
+    for (int t = 0; t < threads; t++)
+        for (int c = 0; c < count; c++)
+            stamp[t][c] = -1;
+    next.targets = new int[next.offsets[count]];
+    next.weights = new long long[next.offsets[count]];
+    Parallel::forDynamic(0, count, 64, threads, [&](int t, long long lo, long long hi) {
+        for (long long c = lo; c < hi; c++) {
+            int size = gather(t, static_cast<int>(c));
+            long long pos = next.offsets[c];
+            for (int k = 0; k < size; k++) {
+                next.targets[pos + k] = list[t][k];
+                next.weights[pos + k] = sum[t][list[t][k]];
+            }
+        }
+    });
+    for (int t = 0; t < threads; t++) {
+        delete[] stamp[t];
+        delete[] sum[t];
+        delete[] list[t];
+    }
+    delete[] stamp;
+    delete[] sum;
+    delete[] list;
+    delete[] memberStart;
+    delete[] members;
+    return next;
+}
+
+// louvain: local moving, then contraction, until a level moves nothing.
+// The original vertices' ids are composed with each level's assignment.
+int Communities::louvain(const CSRGraph& g, int* community, double resolution, int threads) {
+    GRAPH_INSTRUMENT_SCOPE("louvain");
+    int n = g.getNumVertices();
+    const int* weights = g.getWeights();
+    long long totalWeight = 0;
+    for (long long e = 0; e < g.getNumEntries(); e++) {
+        if (weights[e] < 0)
+            throw "Negative edge weight";
+        totalWeight += weights[e];
+    }
+    for (int v = 0; v < n; v++)
+        community[v] = v;
+    if (totalWeight == 0)
+        return n;
+    Level level;
+    level.numVertices = n;
+    level.offsets = new long long[n + 1];
+    level.targets = new int[g.getNumEntries()];
+    level.weights = new long long[g.getNumEntries()];
+    std::copy(g.getOffsets(), g.getOffsets() + n + 1, level.offsets);
+    std::copy(g.getTargets(), g.getTargets() + g.getNumEntries(), level.targets);
+    std::copy(weights, weights + g.getNumEntries(), level.weights);
+    int count = n;
+    while (true) {
+        int* assign = new int[level.numVertices];
+        bool moved = moveLocal(level, assign, resolution, static_cast<double>(totalWeight), threads);
+        count = renumber(assign, level.numVertices);
+        for (int v = 0; v < n; v++)
+            community[v] = assign[community[v]];
+        bool done = !moved || count == level.numVertices;
+        if (!done) {
+            Level next = contract(level, assign, count, threads);
+            release(level);
+            level = next;
+        }
+        delete[] assign;
+        if (done)
+            break;
+    }
+    release(level);
+    return count;
+}
+
+int Communities::louvain(const Graph& g, int* community, double resolution, int threads) {
+    return louvain(CSRGraph::fromGraph(g, threads), community, resolution, threads);
+}
+
+double Communities::modularity(const CSRGraph& g, const int* community, double resolution) {
+    int n = g.getNumVertices();
+    for (int v = 0; v < n; v++)
+        if (community[v] < 0 || community[v] >= n)
+            throw "Community id out of range";
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    const int* weights = g.getWeights();
+    double* total = new double[n]();
+    double inside = 0, totalWeight = 0;
+    for (int v = 0; v < n; v++)
+        for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+            total[community[v]] += weights[e];
+            totalWeight += weights[e];
+            if (community[targets[e]] == community[v])
+                inside += weights[e];
+        }
+    double quality = 0;
+    if (totalWeight != 0) {
+        quality = inside / totalWeight;
+        for (int c = 0; c < n; c++)
+            quality -= resolution * (total[c] / totalWeight) * (total[c] / totalWeight);
+    }
+    delete[] total;
+    return quality;
+}
+
+} // namespace graph
+
+#endif // COMMUNITIES_CPP
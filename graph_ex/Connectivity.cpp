@@ -0,0 +1,376 @@
+// Connectivity.cpp
+#ifndef CONNECTIVITY_CPP
+#define CONNECTIVITY_CPP
+
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <atomic>
+
+namespace graph {
+
+// Strongly connected components of directed graphs, and bridges, articulation
+// points and biconnected components of undirected ones. Every depth-first
+// search keeps its own stack on the heap, so long paths do not exhaust the
+// call stack. All routines run in O(V + E).
+class Connectivity {
+public:
+    // Tarjan's SCC over the arcs src[i] -> dst[i]. component[v] receives an id
+    // in 0 .. count - 1; returns count. With trim, vertices that have no live
+    // in-arcs or no live out-arcs are first peeled off in parallel rounds as
+    // singleton components, which leaves Tarjan only the cyclic core.
+    // Without trim, ids follow a reverse topological order of the components.
+    static int stronglyConnected(int vertices, const int* src, const int* dst, long long count, int* component,
+                                 bool trim = true, int threads = 0);
+    // isBridge[e] for every entry e of g: whether removing the edge splits its
+    // component. Returns the number of bridges (edges, not entries). The
+    // Graph overloads of the per-entry routines index entries in adjacency
+    // list order, vertex by vertex, as CSRGraph::fromGraph lays them out.
+    static long long bridges(const CSRGraph& g, bool* isBridge);
+    static long long bridges(const Graph& g, bool* isBridge);
+    // isCut[v]: whether removing v splits its component. Returns their number.
+    static int articulationPoints(const CSRGraph& g, bool* isCut);
+    static int articulationPoints(const Graph& g, bool* isCut);
+    // Biconnected components (blocks: maximal sets of edges in which any two
+    // lie on a common simple cycle, or a single bridge). Blocks partition the
+    // edges and meet at articulation points. component[e] for every entry e
+    // of g (both entries of an edge agree; self-loops get -1). Returns the
+    // block count.
+    static int biconnectedComponents(const CSRGraph& g, int* component);
+    static int biconnectedComponents(const Graph& g, int* component);
+
+private:
+    // Depth-first search over every component of g. order[v] = discovery
+    // index, parent[v] = tree parent (-1 for roots), low[v] = lowest order
+    // reachable from v's subtree by one non-tree edge. A single entry back to
+    // the parent is skipped, so a parallel edge still counts. When block is
+    // given, block[v] receives the block of the tree edge (parent[v], v) and
+    // the return value is the number of blocks.
+    static int lowpoint(const CSRGraph& g, int* order, int* low, int* parent, int* block);
+    // The later-discovered end of edge {u, v}, which owns the edge.
+    static int treeChild(const int* order, int u, int v);
+};
+
+// stronglyConnected: the arcs are bucketed into forward rows (and, for
+// trimming, reverse rows). Trimming keeps live in- and out-degrees, ignoring
+// self-loops; removing a vertex decrements its neighbours, and the one that
+// takes a count to zero claims the neighbour for the next round. Trimmed
+// vertices are numbered first, in vertex order. Tarjan's search then walks
+// the remaining vertices with a per-vertex arc cursor: a vertex is on the
+// component stack while it has an order but no component.
+int Connectivity::stronglyConnected(int vertices, const int* src, const int* dst, long long count, int* component,
+                                    bool trim, int threads) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    for (long long i = 0; i < count; i++)
+        if (src[i] < 0 || src[i] >= vertices || dst[i] < 0 || dst[i] >= vertices)
+            throw "Vertex index out of range";
+    GRAPH_INSTRUMENT_SCOPE("scc");
+    int n = vertices;
+    long long* offsets = new long long[n + 1]();
+    int* targets = new int[count + 1];
+    for (long long i = 0; i < count; i++)
+        offsets[src[i] + 1]++;
+    for (int v = 0; v < n; v++)
+        offsets[v + 1] += offsets[v];
+    long long* cursor = new long long[n];
+    std::copy(offsets, offsets + n, cursor);
+    for (long long i = 0; i < count; i++)
+        targets[cursor[src[i]]++] = dst[i];
+    for (int v = 0; v < n; v++)
+        component[v] = -1;
+    int numComponents = 0;
+    if (trim) {
+        long long* inOffsets = new long long[n + 1]();
+        int* sources = new int[count + 1];
+        for (long long i = 0; i < count; i++)
+            inOffsets[dst[i] + 1]++;
+        for (int v = 0; v < n; v++)
+            inOffsets[v + 1] += inOffsets[v];
+        std::copy(inOffsets, inOffsets + n, cursor);
+        for (long long i = 0; i < count; i++)
+            sources[cursor[dst[i]]++] = src[i];
+        std::atomic<int>* inDegree = new std::atomic<int>[n];
+        std::atomic<int>* outDegree = new std::atomic<int>[n];
+        std::atomic<unsigned char>* removed = new std::atomic<unsigned char>[n];
+        int* frontier = new int[n];
+        int* next = new int[n];
+        std::atomic<long long> nextSize(0);
+        Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+            for (long long v = lo; v < hi; v++) {
+                int in = 0, out = 0;
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+                    if (targets[e] != v)
+                        out++;
+                for (long long e = inOffsets[v]; e < inOffsets[v + 1]; e++)
+                    if (sources[e] != v)
+                        in++;
+                inDegree[v].store(in, std::memory_order_relaxed);
+                outDegree[v].store(out, std::memory_order_relaxed);
+                removed[v].store(in == 0 || out == 0, std::memory_order_relaxed);
+                if (in == 0 || out == 0)
+                    frontier[nextSize.fetch_add(1, std::memory_order_relaxed)] = static_cast<int>(v);
+            }
+        });
+        long long frontierSize = nextSize.load();
+        while (frontierSize > 0) {
+            nextSize.store(0, std::memory_order_relaxed);
+            Parallel::forDynamic(0, frontierSize, 256, threads, [&](int, long long lo, long long hi) {
+                for (long long i = lo; i < hi; i++) {
+                    int u = frontier[i];
+                    for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                        int w = targets[e];
+                        if (w != u && inDegree[w].fetch_sub(1, std::memory_order_relaxed) == 1 &&
+                            !removed[w].exchange(1, std::memory_order_relaxed))
+                            next[nextSize.fetch_add(1, std::memory_order_relaxed)] = w;
+                    }
+                    for (long long e = inOffsets[u]; e < inOffsets[u + 1]; e++) {
+                        int w = sources[e];
+                        if (w != u && outDegree[w].fetch_sub(1, std::memory_order_relaxed) == 1 &&
+                            !removed[w].exchange(1, std::memory_order_relaxed))
+                            next[nextSize.fetch_add(1, std::memory_order_relaxed)] = w;
+                    }
+                }
+            });
+            std::swap(frontier, next);
+            frontierSize = nextSize.load();
+        }
+        for (int v = 0; v < n; v++)
+            if (removed[v].load(std::memory_order_relaxed))
+                component[v] = numComponents++;
+        GRAPH_COUNT(edgesScanned, 2 * count);
+        delete[] inOffsets;
+        delete[] sources;
+        delete[] inDegree;
+        delete[] outDegree;
+        delete[] removed;
+        delete[] frontier;
+        delete[] next;
+    }
+    int* order = new int[n];
+    int* low = new int[n];
+    int* callStack = new int[n];
+    int* sccStack = new int[n];
+    for (int v = 0; v < n; v++)
+        order[v] = -1;
+    int counter = 0;
+    for (int root = 0; root < n; root++) {
+        if (component[root] >= 0 || order[root] >= 0)
+            continue;
+        int callTop = 0, sccTop = 0;
+        order[root] = low[root] = counter++;
+        cursor[root] = offsets[root];
+        callStack[0] = root;
+        sccStack[0] = root;
+        while (callTop >= 0) {
+            int v = callStack[callTop];
+            if (cursor[v] < offsets[v + 1]) {
+                int w = targets[cursor[v]++];
+                if (order[w] < 0) {
+                    if (component[w] >= 0) // Trimmed.
+                        continue;
+                    order[w] = low[w] = counter++;
+                    cursor[w] = offsets[w];
+                    callStack[++callTop] = w;
+                    sccStack[++sccTop] = w;
+                } else if (component[w] < 0 && order[w] < low[v]) {
+                    low[v] = order[w];
+                }
+                continue;
+            }
+            callTop--;
+            if (callTop >= 0 && low[v] < low[callStack[callTop]])
+                low[callStack[callTop]] = low[v];
+            if (low[v] == order[v]) {
+                int w;
+                do {
+                    w = sccStack[sccTop--];
+                    component[w] = numComponents;
+                } while (w != v);
+                numComponents++;
+            }
+        }
+    }
+    GRAPH_COUNT(edgesScanned, count);
+    delete[] offsets;
+    delete[] targets;
+    delete[] cursor;
+    delete[] order;
+    delete[] low;
+    delete[] callStack;
+    delete[] sccStack;
+    return numComponents;
+}
+
+// lowpoint: the iterative Hopcroft-Tarjan search. Tree vertices also go on a
+// vertex stack; when a child v finishes with low[v] >= order[parent], the
+// vertices above and including v close a block. skipped[v] marks that the
+// one entry back to the parent has been passed over.
+int Connectivity::lowpoint(const CSRGraph& g, int* order, int* low, int* parent, int* block) {
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    long long* cursor = new long long[n];
+    bool* skipped = new bool[n];
+    int* callStack = new int[n];
+    int* blockStack = new int[n];
+    for (int v = 0; v < n; v++)
+        order[v] = -1;
+    int counter = 0, blocks = 0;
+    for (int root = 0; root < n; root++) {
+        if (order[root] >= 0)
+            continue;
+        int callTop = 0, blockTop = -1;
+        order[root] = low[root] = counter++;
+        parent[root] = -1;
+        cursor[root] = offsets[root];
+        callStack[0] = root;
+        while (callTop >= 0) {
+            int v = callStack[callTop];
+            if (cursor[v] < offsets[v + 1]) {
+                int w = targets[cursor[v]++];
+                if (order[w] < 0) {
+                    order[w] = low[w] = counter++;
+                    parent[w] = v;
+                    skipped[w] = false;
+                    cursor[w] = offsets[w];
+                    callStack[++callTop] = w;
+                    blockStack[++blockTop] = w;
+                } else if (w == parent[v] && !skipped[v]) {
+                    skipped[v] = true;
+                } else if (order[w] < low[v]) {
+                    low[v] = order[w];
+                }
+                continue;
+            }
+            callTop--;
+            if (callTop < 0)
+                break;
+            int u = callStack[callTop];
+            if (low[v] < low[u])
+                low[u] = low[v];
+            if (block && low[v] >= order[u]) {
+                int w;
+                do {
+                    w = blockStack[blockTop--];
+                    block[w] = blocks;
+                } while (w != v);
+                blocks++;
+            }
+        }
+    }
+    GRAPH_COUNT(edgesScanned, g.getNumEntries());
+    delete[] cursor;
+    delete[] skipped;
+    delete[] callStack;
+    delete[] blockStack;
+    return blocks;
+}
+
+// treeChild: in an undirected DFS every non-tree edge joins a vertex to one
+// of its ancestors, so each edge is owned by its later-discovered end.
+int Connectivity::treeChild(const int* order, int u, int v) {
+    return order[u] > order[v] ? u : v;
+}
+
+// bridges: tree edge (parent[v], v) is a bridge iff low[v] > order[parent[v]];
+// a non-tree edge never is. A parallel copy of a tree edge is a non-tree
+// edge and pulls low[v] down to the parent, so doubled edges are not bridges.
+long long Connectivity::bridges(const CSRGraph& g, bool* isBridge) {
+    GRAPH_INSTRUMENT_SCOPE("bridges");
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    int* order = new int[n];
+    int* low = new int[n];
+    int* parent = new int[n];
+    lowpoint(g, order, low, parent, 0);
+    long long count = 0;
+    for (int u = 0; u < n; u++)
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = targets[e];
+            int child = treeChild(order, u, v);
+            int other = child == u ? v : u;
+            isBridge[e] = u != v && parent[child] == other && low[child] > order[other];
+            if (isBridge[e] && u < v)
+                count++;
+        }
+    delete[] order;
+    delete[] low;
+    delete[] parent;
+    return count;
+}
+
+long long Connectivity::bridges(const Graph& g, bool* isBridge) {
+    return bridges(CSRGraph::fromGraph(g), isBridge);
+}
+
+// articulationPoints: a root is a cut vertex iff it has two tree children;
+// any other u iff some child v has low[v] >= order[u].
+int Connectivity::articulationPoints(const CSRGraph& g, bool* isCut) {
+    GRAPH_INSTRUMENT_SCOPE("articulation_points");
+    int n = g.getNumVertices();
+    int* order = new int[n];
+    int* low = new int[n];
+    int* parent = new int[n];
+    int* children = new int[n]();
+    lowpoint(g, order, low, parent, 0);
+    for (int v = 0; v < n; v++)
+        isCut[v] = false;
+    for (int v = 0; v < n; v++) {
+        int u = parent[v];
+        if (u < 0)
+            continue;
+        children[u]++;
+        if (parent[u] >= 0 && low[v] >= order[u])
+            isCut[u] = true;
+    }
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        if (parent[v] < 0 && children[v] >= 2)
+            isCut[v] = true;
+        if (isCut[v])
+            count++;
+    }
+    delete[] order;
+    delete[] low;
+    delete[] parent;
+    delete[] children;
+    return count;
+}
+
+int Connectivity::articulationPoints(const Graph& g, bool* isCut) {
+    return articulationPoints(CSRGraph::fromGraph(g), isCut);
+}
+
+// biconnectedComponents: each edge takes the block of its later-discovered
+// end's tree edge.
+int Connectivity::biconnectedComponents(const CSRGraph& g, int* component) {
+    GRAPH_INSTRUMENT_SCOPE("biconnected_components");
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    int* order = new int[n];
+    int* low = new int[n];
+    int* parent = new int[n];
+    int* block = new int[n];
+    int blocks = lowpoint(g, order, low, parent, block);
+    for (int u = 0; u < n; u++)
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = targets[e];
+            component[e] = v == u ? -1 : block[treeChild(order, u, v)];
+        }
+    delete[] order;
+    delete[] low;
+    delete[] parent;
+    delete[] block;
+    return blocks;
+}
+
+int Connectivity::biconnectedComponents(const Graph& g, int* component) {
+    return biconnectedComponents(CSRGraph::fromGraph(g), component);
+}
+
+} // namespace graph
+
+#endif // CONNECTIVITY_CPP
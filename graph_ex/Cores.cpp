@@ -0,0 +1,142 @@
+// Cores.cpp
+#ifndef CORES_CPP
+#define CORES_CPP
+
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <atomic>
+
+namespace graph {
+
+// k-core decomposition. The k-core is the largest subgraph in which every
+// vertex has at least k neighbours; the core number of v is the largest k
+// whose k-core contains v. Self-loops and parallel edges are ignored.
+class Cores {
+public:
+    // Core number of every vertex; returns the degeneracy (largest core number).
+    static int coreNumbers(const CSRGraph& g, int* core, int threads = 0);
+    static int coreNumbers(const Graph& g, int* core, int threads = 0);
+    // inCore[v] = whether v belongs to the k-core; returns its size.
+    static int kCore(const CSRGraph& g, int k, bool* inCore, int threads = 0);
+};
+
+// coreNumbers: peels by level. Level k repeatedly removes every vertex whose
+// remaining degree is at most k, a whole frontier at a time in parallel: each
+// removal decrements its neighbours, and a neighbour that drops to exactly k
+// joins the next frontier of the same level. A neighbour that stays above k
+// is pushed onto the bucket of its new degree (a lock-free list), so a level
+// starts from its bucket instead of a scan of all vertices. Degrees only
+// fall, so a vertex enters each bucket at most once and entries whose degree
+// has since dropped are skipped: O(V + E + maxDegree) work overall.
+int Cores::coreNumbers(const CSRGraph& g, int* core, int threads) {
+    GRAPH_INSTRUMENT_SCOPE("kcore");
+    int n = g.getNumVertices();
+    CSRGraph sorted(g);
+    sorted.sortNeighbors(threads);
+    const long long* offsets = sorted.getOffsets();
+    const int* targets = sorted.getTargets();
+    // Distinct neighbours, not counting the vertex itself.
+    auto counts = [&](long long v, long long e) {
+        return targets[e] != v && (e == offsets[v] || targets[e] != targets[e - 1]);
+    };
+    std::atomic<int>* degree = new std::atomic<int>[n];
+    int maxDegree = 0;
+    for (int v = 0; v < n; v++) {
+        int d = 0;
+        for (long long e = offsets[v]; e < offsets[v + 1]; e++)
+            if (counts(v, e))
+                d++;
+        degree[v].store(d, std::memory_order_relaxed);
+        if (d > maxDegree)
+            maxDegree = d;
+    }
+    // Bucket lists share one node pool: V initial entries plus at most one per entry.
+    long long capacity = n + sorted.getNumEntries();
+    int* nodeVertex = new int[capacity];
+    long long* nodeNext = new long long[capacity];
+    std::atomic<long long> used(0);
+    std::atomic<long long>* head = new std::atomic<long long>[maxDegree + 1];
+    for (int d = 0; d <= maxDegree; d++)
+        head[d].store(-1, std::memory_order_relaxed);
+    auto push = [&](int d, int v) {
+        long long node = used.fetch_add(1, std::memory_order_relaxed);
+        nodeVertex[node] = v;
+        long long old = head[d].load(std::memory_order_relaxed);
+        do {
+            nodeNext[node] = old;
+        } while (!head[d].compare_exchange_weak(old, node, std::memory_order_release, std::memory_order_relaxed));
+    };
+    for (int v = n - 1; v >= 0; v--)
+        push(degree[v].load(std::memory_order_relaxed), v);
+    int* frontier = new int[n];
+    int* next = new int[n];
+    std::atomic<long long> nextSize(0);
+    int degeneracy = 0;
+    for (int k = 0; k <= maxDegree; k++) {
+        long long frontierSize = 0;
+        for (long long node = head[k].load(std::memory_order_acquire); node != -1; node = nodeNext[node]) {
+            int v = nodeVertex[node];
+            if (degree[v].load(std::memory_order_relaxed) == k) {
+                core[v] = k;
+                frontier[frontierSize++] = v;
+            }
+        }
+        if (frontierSize > 0)
+            degeneracy = k;
+        while (frontierSize > 0) {
+            nextSize.store(0, std::memory_order_relaxed);
+            Parallel::forDynamic(0, frontierSize, 64, threads, [&](int, long long lo, long long hi) {
+                for (long long i = lo; i < hi; i++) {
+                    int u = frontier[i];
+                    for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                        if (!counts(u, e))
+                            continue;
+                        int w = targets[e];
+                        int d = degree[w].fetch_sub(1, std::memory_order_relaxed) - 1;
+                        if (d == k) {
+                            core[w] = k;
+                            next[nextSize.fetch_add(1, std::memory_order_relaxed)] = w;
+                        } else if (d > k) {
+                            push(d, w);
+                        }
+                    }
+                }
+            });
+            int* swapTmp = frontier;
+            frontier = next;
+            next = swapTmp;
+            frontierSize = nextSize.load(std::memory_order_relaxed);
+        }
+    }
+    GRAPH_COUNT(edgesScanned, sorted.getNumEntries());
+    delete[] degree;
+    delete[] nodeVertex;
+    delete[] nodeNext;
+    delete[] head;
+    delete[] frontier;
+    delete[] next;
+    return degeneracy;
+}
+
+int Cores::coreNumbers(const Graph& g, int* core, int threads) {
+    return coreNumbers(CSRGraph::fromGraph(g, threads), core, threads);
+}
+
+int Cores::kCore(const CSRGraph& g, int k, bool* inCore, int threads) {
+    int n = g.getNumVertices();
+    int* core = new int[n];
+    coreNumbers(g, core, threads);
+    int size = 0;
+    for (int v = 0; v < n; v++) {
+        inCore[v] = core[v] >= k;
+        if (inCore[v])
+            size++;
+    }
+    delete[] core;
+    return size;
+}
+
+} // namespace graph
+
+#endif // CORES_CPP
@@ -0,0 +1,368 @@
+// DenseGraph.cpp
+#ifndef DENSEGRAPH_CPP
+#define DENSEGRAPH_CPP
+
+#include "Algorithms.cpp"
+#include <algorithm>
+
+namespace graph {
+
+// Adjacency-matrix representation of an undirected weighted graph for dense
+// inputs: row v is a packed bitset of v's neighbours (64 per word) and an
+// n x n matrix holds the weights. Parallel edges collapse to the lightest one.
+// BFS works on whole words of the bitsets and Prim runs in O(n^2) with plain
+// arrays, which beats the linked lists once the density reaches a few percent.
+class DenseGraph {
+public:
+    static const int MaxVertices = 16384; // Weight matrix is 4 * n^2 bytes.
+    static const double DensityThreshold; // Edge fraction from which dense wins.
+    static const long long PreferredBytes; // Memory cap for automatic selection.
+
+    // Constructors, destructor, and assignment operator.
+    DenseGraph(int vertices);
+    ~DenseGraph();
+    DenseGraph(const DenseGraph& other);
+    DenseGraph(DenseGraph&& other) noexcept; // Leaves 'other' empty: destroy or assign only.
+    DenseGraph& operator=(DenseGraph other); // Uses copy-swap idiom.
+    friend void swap(DenseGraph& a, DenseGraph& b);
+
+    // Whether a graph of this size should use the dense backend: dense
+    // enough, and both matrices within PreferredBytes. Callers that hold a
+    // graph for many queries make the switch; converting costs more than one
+    // BFS or Prim call saves, so the Graph algorithms never convert per call.
+    static bool preferred(int vertices, long long edges);
+    static bool preferred(const Graph& g);
+
+    // Conversions.
+    static DenseGraph fromGraph(const Graph& g);
+    Graph toGraph() const;
+
+    // Graph operations. Adding an existing edge keeps the lighter weight.
+    void addEdge(int source, int dest, int weight = 1);
+    void removeEdge(int source, int dest);
+    bool hasEdge(int source, int dest) const;
+    int getWeight(int source, int dest) const;
+
+    // Algorithms (same results as the Algorithms versions, up to ties).
+    Graph bfs(int source) const; // Word-parallel, O(n^2 / 64) in total.
+    Graph prim() const;          // O(n^2) array-based.
+
+    // Accessors.
+    int getNumVertices() const;
+    long long getNumEdges() const;
+    int getDegree(int vertex) const;           // Distinct neighbours.
+    int getWordsPerRow() const;
+    const unsigned long long* row(int vertex) const; // getWordsPerRow() words.
+
+private:
+    int numVertices;
+    int words;               // 64-bit words per bitset row.
+    long long numEdges;
+    unsigned long long* bits; // numVertices rows of 'words' words.
+    int* weights;            // numVertices x numVertices, valid where the bit is set.
+
+    void checkVertex(int vertex) const;
+    void setBit(int u, int v);
+    void clearBit(int u, int v);
+    bool testBit(int u, int v) const;
+};
+
+const double DenseGraph::DensityThreshold = 0.03;
+const long long DenseGraph::PreferredBytes = 64LL << 20;
+
+// Constructor: allocate an empty bit matrix and a zeroed weight matrix.
+DenseGraph::DenseGraph(int vertices) : numVertices(vertices), numEdges(0) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    if (vertices > MaxVertices)
+        throw "Too many vertices for a dense graph";
+    words = (vertices + 63) / 64;
+    bits = new unsigned long long[static_cast<long long>(numVertices) * words]();
+    weights = new int[static_cast<long long>(numVertices) * numVertices]();
+}
+
+DenseGraph::~DenseGraph() {
+    delete[] bits;
+    delete[] weights;
+}
+
+DenseGraph::DenseGraph(const DenseGraph& other)
+    : numVertices(other.numVertices), words(other.words), numEdges(other.numEdges) {
+    long long numBits = static_cast<long long>(numVertices) * words;
+    long long numWeights = static_cast<long long>(numVertices) * numVertices;
+    bits = new unsigned long long[numBits];
+    weights = new int[numWeights];
+    std::copy(other.bits, other.bits + numBits, bits);
+    std::copy(other.weights, other.weights + numWeights, weights);
+}
+
+DenseGraph::DenseGraph(DenseGraph&& other) noexcept
+    : numVertices(other.numVertices), words(other.words), numEdges(other.numEdges),
+      bits(other.bits), weights(other.weights) {
+    other.numVertices = 0;
+    other.words = 0;
+    other.numEdges = 0;
+    other.bits = 0;
+    other.weights = 0;
+}
+
+void swap(DenseGraph& a, DenseGraph& b) {
+    std::swap(a.numVertices, b.numVertices);
+    std::swap(a.words, b.words);
+    std::swap(a.numEdges, b.numEdges);
+    std::swap(a.bits, b.bits);
+    std::swap(a.weights, b.weights);
+}
+
+DenseGraph& DenseGraph::operator=(DenseGraph other) {
+    swap(*this, other);
+    return *this;
+}
+
+// preferred: dense once 2E / (n (n - 1)) reaches the threshold and the
+// weight matrix plus bitset rows fit in PreferredBytes (n up to about 4000).
+bool DenseGraph::preferred(int vertices, long long edges) {
+    if (vertices <= 1 || vertices > MaxVertices)
+        return false;
+    long long bytes = static_cast<long long>(vertices) * vertices * sizeof(int) +
+                      static_cast<long long>(vertices) * ((vertices + 63) / 64) * sizeof(unsigned long long);
+    if (bytes > PreferredBytes)
+        return false;
+    double pairs = static_cast<double>(vertices) * (vertices - 1) / 2;
+    return edges >= DensityThreshold * pairs;
+}
+
+bool DenseGraph::preferred(const Graph& g) {
+    long long entries = 0;
+    for (int v = 0; v < g.getNumVertices(); v++)
+        entries += g.getDegree(v);
+    return preferred(g.getNumVertices(), entries / 2);
+}
+
+// fromGraph: one pass over every adjacency list.
+DenseGraph DenseGraph::fromGraph(const Graph& g) {
+    DenseGraph d(g.getNumVertices());
+    for (int u = 0; u < d.numVertices; u++)
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next)
+            if (u <= e->destination)
+                d.addEdge(u, e->destination, e->weight);
+    return d;
+}
+
+// toGraph: one edge per set bit of the upper triangle (diagonal included).
+Graph DenseGraph::toGraph() const {
+    Graph g(numVertices);
+    Graph::EdgeTriple* batch = new Graph::EdgeTriple[numEdges + 1];
+    long long count = 0;
+    for (int u = 0; u < numVertices; u++) {
+        const unsigned long long* r = row(u);
+        for (int w = u / 64; w < words; w++) {
+            unsigned long long word = r[w];
+            if (w == u / 64)
+                word &= ~0ULL << (u % 64);
+            while (word) {
+                int v = w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+                Graph::EdgeTriple e = {u, v, weights[static_cast<long long>(u) * numVertices + v]};
+                batch[count++] = e;
+            }
+        }
+    }
+    g.addEdges(batch, count);
+    delete[] batch;
+    return g;
+}
+
+void DenseGraph::checkVertex(int vertex) const {
+    if (vertex < 0 || vertex >= numVertices)
+        throw "Vertex index out of range";
+}
+
+void DenseGraph::setBit(int u, int v) {
+    bits[static_cast<long long>(u) * words + v / 64] |= 1ULL << (v % 64);
+}
+
+void DenseGraph::clearBit(int u, int v) {
+    bits[static_cast<long long>(u) * words + v / 64] &= ~(1ULL << (v % 64));
+}
+
+bool DenseGraph::testBit(int u, int v) const {
+    return (bits[static_cast<long long>(u) * words + v / 64] >> (v % 64)) & 1ULL;
+}
+
+void DenseGraph::addEdge(int source, int dest, int weight) {
+    checkVertex(source);
+    checkVertex(dest);
+    int* forward = &weights[static_cast<long long>(source) * numVertices + dest];
+    int* reverse = &weights[static_cast<long long>(dest) * numVertices + source];
+    if (testBit(source, dest)) {
+        if (weight < *forward)
+            *forward = *reverse = weight;
+        return;
+    }
+    setBit(source, dest);
+    setBit(dest, source);
+    *forward = *reverse = weight;
+    numEdges++;
+}
+
+void DenseGraph::removeEdge(int source, int dest) {
+    checkVertex(source);
+    checkVertex(dest);
+    if (!testBit(source, dest))
+        throw "Edge does not exist";
+    clearBit(source, dest);
+    clearBit(dest, source);
+    numEdges--;
+}
+
+bool DenseGraph::hasEdge(int source, int dest) const {
+    checkVertex(source);
+    checkVertex(dest);
+    return testBit(source, dest);
+}
+
+int DenseGraph::getWeight(int source, int dest) const {
+    if (!hasEdge(source, dest))
+        throw "Edge does not exist";
+    return weights[static_cast<long long>(source) * numVertices + dest];
+}
+
+// bfs: level-synchronous. Each frontier vertex claims, a word at a time, the
+// neighbours nobody has visited yet (row AND NOT visited), so every word of
+// the matrix is read at most once.
+Graph DenseGraph::bfs(int source) const {
+    if (source < 0 || source >= numVertices)
+        throw "Source vertex out of range";
+    GRAPH_INSTRUMENT_SCOPE("dense_bfs");
+    Graph result(numVertices);
+    unsigned long long* visited = new unsigned long long[words]();
+    int* frontier = new int[numVertices];
+    int* next = new int[numVertices];
+    int frontierSize = 1, nextSize = 0;
+    frontier[0] = source;
+    visited[source / 64] |= 1ULL << (source % 64);
+    while (frontierSize > 0) {
+        GRAPH_COUNT(levels, 1);
+        nextSize = 0;
+        for (int i = 0; i < frontierSize; i++) {
+            int u = frontier[i];
+            const unsigned long long* r = row(u);
+            for (int w = 0; w < words; w++) {
+                unsigned long long fresh = r[w] & ~visited[w];
+                if (!fresh)
+                    continue;
+                visited[w] |= fresh;
+                while (fresh) {
+                    int v = w * 64 + __builtin_ctzll(fresh);
+                    fresh &= fresh - 1;
+                    next[nextSize++] = v;
+                    result.addEdge(u, v, weights[static_cast<long long>(u) * numVertices + v]);
+                }
+            }
+            GRAPH_COUNT(edgesScanned, getDegree(u)); // Edges in the row, as a list scan counts them.
+        }
+        int* swapTmp = frontier;
+        frontier = next;
+        next = swapTmp;
+        frontierSize = nextSize;
+    }
+    delete[] visited;
+    delete[] frontier;
+    delete[] next;
+    return result;
+}
+
+// prim: repeatedly take the cheapest vertex outside the tree and relax the
+// neighbours in its row that are still outside, found a word at a time.
+// Keys of the vertices outside the tree are kept packed in one array (with
+// swap-removal), so the selection is a contiguous O(n) scan. Like
+// Algorithms::prim it starts at vertex 0 and continues into other components.
+Graph DenseGraph::prim() const {
+    GRAPH_INSTRUMENT_SCOPE("dense_prim");
+    int n = numVertices;
+    Graph result(n);
+    int* key = new int[n];
+    int* par = new int[n];
+    int* remaining = new int[n]; // Vertices outside the tree...
+    int* remainingKey = new int[n]; // ...their keys...
+    int* position = new int[n];     // ...and each vertex's index in both.
+    unsigned long long* outside = new unsigned long long[words];
+    for (int i = 0; i < n; i++) {
+        key[i] = MAX_INT_VALUE;
+        par[i] = -1;
+        remaining[i] = position[i] = i;
+        remainingKey[i] = MAX_INT_VALUE;
+    }
+    for (int w = 0; w < words; w++)
+        outside[w] = ~0ULL;
+    if (n % 64)
+        outside[words - 1] = (1ULL << (n % 64)) - 1;
+    key[0] = remainingKey[0] = 0;
+    for (int left = n; left > 0; left--) {
+        // Minimum first (a branch-free, vectorisable reduction), then its index.
+        int lightest = MAX_INT_VALUE;
+        for (int i = 0; i < left; i++)
+            lightest = remainingKey[i] < lightest ? remainingKey[i] : lightest;
+        int best = 0;
+        while (remainingKey[best] != lightest)
+            best++;
+        int u = remaining[best];
+        remaining[best] = remaining[left - 1];
+        remainingKey[best] = remainingKey[left - 1];
+        position[remaining[best]] = best;
+        outside[u / 64] &= ~(1ULL << (u % 64));
+        const unsigned long long* r = row(u);
+        const int* wrow = weights + static_cast<long long>(u) * n;
+        for (int w = 0; w < words; w++) {
+            for (unsigned long long word = r[w] & outside[w]; word; word &= word - 1) {
+                int v = w * 64 + __builtin_ctzll(word);
+                if (wrow[v] < key[v]) {
+                    key[v] = remainingKey[position[v]] = wrow[v];
+                    par[v] = u;
+                }
+            }
+        }
+        GRAPH_COUNT(edgesScanned, getDegree(u));
+    }
+    for (int i = 1; i < n; i++) {
+        if (par[i] != -1)
+            result.addEdge(par[i], i, key[i]);
+    }
+    delete[] key;
+    delete[] par;
+    delete[] remaining;
+    delete[] remainingKey;
+    delete[] position;
+    delete[] outside;
+    return result;
+}
+
+int DenseGraph::getNumVertices() const {
+    return numVertices;
+}
+
+long long DenseGraph::getNumEdges() const {
+    return numEdges;
+}
+
+int DenseGraph::getDegree(int vertex) const {
+    checkVertex(vertex);
+    int degree = 0;
+    const unsigned long long* r = row(vertex);
+    for (int w = 0; w < words; w++)
+        degree += __builtin_popcountll(r[w]);
+    return degree;
+}
+
+int DenseGraph::getWordsPerRow() const {
+    return words;
+}
+
+const unsigned long long* DenseGraph::row(int vertex) const {
+    return bits + static_cast<long long>(vertex) * words;
+}
+
+} // namespace graph
+
+#endif // DENSEGRAPH_CPP
@@ -0,0 +1,400 @@
+// Distances.cpp
+#ifndef DISTANCES_CPP
+#define DISTANCES_CPP
+
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include "SpMV.cpp"
+#include <cmath>
+
+namespace graph {
+
+// Approximate hop-distance statistics of undirected graphs: diameter bounds,
+// sampled eccentricities and the neighbourhood function. Every routine costs
+// a bounded number of linear passes, so none needs a BFS from every vertex.
+// Edge weights and directions are ignored; distances count hops.
+class Distances {
+public:
+    // Diameter bounds by iterative fringe upper bounding (iFUB): a 4-sweep
+    // picks a central vertex u, then the BFS levels of u are walked from the
+    // deepest down, with one BFS per fringe vertex. Runs at most maxSweeps
+    // BFSs. Returns the lower bound; *upper (if given) receives the upper
+    // bound, and the two are equal when the diameter is exact. Both refer to
+    // the component of the highest-degree vertex.
+    static int diameter(const CSRGraph& g, int* upper = 0, int maxSweeps = 64, int threads = 0);
+    static int diameter(const Graph& g, int* upper = 0, int maxSweeps = 64, int threads = 0);
+    // Eccentricity bounds from 'samples' BFSs whose sources are drawn uniformly
+    // with replacement. Each vertex gets lower[v] <= ecc(v) <= upper[v];
+    // upper[v] is -1 when no source reaches v. Returns how many vertices are
+    // pinned (lower == upper).
+    static int eccentricities(const CSRGraph& g, int samples, int* lower, int* upper, unsigned long long seed,
+                              int threads = 0);
+    static int eccentricities(const Graph& g, int samples, int* lower, int* upper, unsigned long long seed,
+                              int threads = 0);
+    // HyperANF: nf[t] estimates the number of ordered pairs (x, y) with
+    // d(x, y) <= t, self-pairs included, using one HyperLogLog counter of
+    // 2^registerBits registers per vertex (relative error about
+    // 1.04 / 2^(registerBits / 2) per counter). Stops early once no counter
+    // changes. Returns the number of entries written, at most maxDistance + 1.
+    static int neighbourhoodFunction(const CSRGraph& g, double* nf, int maxDistance, int registerBits = 6,
+                                     unsigned long long seed = 1, int threads = 0);
+    static int neighbourhoodFunction(const Graph& g, double* nf, int maxDistance, int registerBits = 6,
+                                     unsigned long long seed = 1, int threads = 0);
+    // Smallest (interpolated) distance within which 'fraction' of the pairs
+    // counted by nf[count - 1] lie.
+    static double effectiveDiameter(const double* nf, int count, double fraction = 0.9);
+
+private:
+    // BFS from source into level; returns the eccentricity of source and sets
+    // *farthest to the lowest-numbered vertex at that distance.
+    static int sweep(const CSRGraph& g, int source, int* level, int* farthest, int threads);
+    // The vertex halfway along a shortest path from the BFS root to 'end'.
+    static int midpoint(const CSRGraph& g, const int* level, int end);
+    // HyperLogLog estimate of a counter of 'words' packed byte registers.
+    static double estimate(const unsigned long long* counter, int words);
+};
+
+// diameter: every ecc() found is a real distance, so the largest is a lower
+// bound. With all vertices at depth >= i below u already swept, a pair whose
+// ends both lie shallower than i is at most 2 (i - 1) apart, and any other
+// pair is covered by a swept eccentricity; so after each fringe the diameter
+// is at most max(lower, 2 (i - 1)). The search stops when the bounds meet,
+// which on real-world graphs usually happens within a few fringes.
+int Distances::diameter(const CSRGraph& g, int* upper, int maxSweeps, int threads) {
+    int n = g.getNumVertices();
+    if (n <= 0)
+        throw "Number of vertices must be positive";
+    if (maxSweeps <= 0)
+        throw "At least one sweep is required";
+    GRAPH_INSTRUMENT_SCOPE("diameter");
+    const long long* offsets = g.getOffsets();
+    int root = 0;
+    for (int v = 1; v < n; v++)
+        if (offsets[v + 1] - offsets[v] > offsets[root + 1] - offsets[root])
+            root = v;
+    int* level = new int[n];
+    int* centre = new int[n];
+    int sweeps = 0;
+    int far = root;
+    int e = sweep(g, root, level, &far, threads);
+    sweeps++;
+    int lower = e;
+    int high = 2 * e;
+    // 4-sweep: two double sweeps, the second from the middle of the first.
+    int mid = root;
+    for (int round = 0; round < 2 && sweeps + round + 1 <= maxSweeps; round++) {
+        if (round > 0) {
+            e = sweep(g, mid, level, &far, threads);
+            sweeps++;
+            if (2 * e < high)
+                high = 2 * e;
+        }
+        int end = far;
+        e = sweep(g, far, level, &end, threads);
+        sweeps++;
+        if (e > lower)
+            lower = e;
+        mid = midpoint(g, level, end);
+    }
+    if (sweeps < maxSweeps && lower < high) {
+        int depth = sweep(g, mid, centre, &far, threads);
+        sweeps++;
+        if (depth > lower)
+            lower = depth;
+        if (2 * depth < high)
+            high = 2 * depth;
+        // Bucket the component by depth below u.
+        int* start = new int[depth + 2]();
+        for (int v = 0; v < n; v++)
+            if (centre[v] >= 0)
+                start[centre[v] + 1]++;
+        for (int i = 0; i <= depth; i++)
+            start[i + 1] += start[i];
+        int* fringe = new int[start[depth + 1]];
+        int* fill = new int[depth + 1];
+        std::copy(start, start + depth + 1, fill);
+        for (int v = 0; v < n; v++)
+            if (centre[v] >= 0)
+                fringe[fill[centre[v]]++] = v;
+        delete[] fill;
+        for (int i = depth; i > 0 && lower < high; i--) {
+            bool complete = true;
+            for (int j = start[i]; j < start[i + 1] && lower < high; j++) {
+                if (sweeps == maxSweeps) {
+                    complete = false;
+                    break;
+                }
+                e = sweep(g, fringe[j], level, &far, threads);
+                sweeps++;
+                if (e > lower)
+                    lower = e;
+            }
+            if (!complete)
+                break;
+            int bound = lower > 2 * (i - 1) ? lower : 2 * (i - 1);
+            if (bound < high)
+                high = bound;
+        }
+        delete[] start;
+        delete[] fringe;
+    }
+    if (high < lower)
+        high = lower;
+    delete[] level;
+    delete[] centre;
+    if (upper)
+        *upper = high;
+    return lower;
+}
+
+int Distances::diameter(const Graph& g, int* upper, int maxSweeps, int threads) {
+    return diameter(CSRGraph::fromGraph(g, threads), upper, maxSweeps, threads);
+}
+
+// eccentricities: in an undirected graph d(v, s) <= ecc(v) and, by the
+// triangle inequality, ecc(s) - d(v, s) <= ecc(v) <= ecc(s) + d(v, s).
+// Sources are drawn up front from a SplitMix64 stream, so the bounds do not
+// depend on the thread count.
+int Distances::eccentricities(const CSRGraph& g, int samples, int* lower, int* upper, unsigned long long seed,
+                              int threads) {
+    int n = g.getNumVertices();
+    if (n <= 0)
+        throw "Number of vertices must be positive";
+    if (samples <= 0)
+        throw "At least one sample is required";
+    GRAPH_INSTRUMENT_SCOPE("eccentricity");
+    for (int v = 0; v < n; v++) {
+        lower[v] = 0;
+        upper[v] = -1;
+    }
+    int* level = new int[n];
+    unsigned long long state = seed;
+    for (int i = 0; i < samples; i++) {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        int source = static_cast<int>((z ^ (z >> 31)) % static_cast<unsigned long long>(n));
+        int far;
+        int e = sweep(g, source, level, &far, threads);
+        Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+            for (long long v = lo; v < hi; v++) {
+                int d = level[v];
+                if (d < 0)
+                    continue;
+                int low = d > e - d ? d : e - d;
+                if (low > lower[v])
+                    lower[v] = low;
+                if (upper[v] < 0 || e + d < upper[v])
+                    upper[v] = e + d;
+            }
+        });
+    }
+    delete[] level;
+    int pinned = 0;
+    for (int v = 0; v < n; v++)
+        if (lower[v] == upper[v])
+            pinned++;
+    return pinned;
+}
+
+int Distances::eccentricities(const Graph& g, int samples, int* lower, int* upper, unsigned long long seed,
+                              int threads) {
+    return eccentricities(CSRGraph::fromGraph(g, threads), samples, lower, upper, seed, threads);
+}
+
+// neighbourhoodFunction: after round t the counter of v holds the ball of
+// radius t around v, the union of its own counter and its neighbours' from
+// round t - 1. Registers are bytes (at most 65 - registerBits, so the high
+// bit is clear) packed eight to a word, and a union takes the bytewise
+// maximum of two words with one subtraction and a few masks. A counter can
+// only change if some neighbour's changed in the previous round; the others
+// are copied without touching their neighbours' counters.
+int Distances::neighbourhoodFunction(const CSRGraph& g, double* nf, int maxDistance, int registerBits,
+                                     unsigned long long seed, int threads) {
+    int n = g.getNumVertices();
+    if (maxDistance < 0)
+        throw "Distance must be non-negative";
+    if (registerBits < 4 || registerBits > 16)
+        throw "Register bits must be in [4, 16]";
+    GRAPH_INSTRUMENT_SCOPE("hyperanf");
+    threads = Parallel::resolve(threads);
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    int words = (1 << registerBits) / 8;
+    unsigned long long* current = new unsigned long long[static_cast<long long>(n) * words]();
+    unsigned long long* next = new unsigned long long[static_cast<long long>(n) * words];
+    unsigned char* changed = new unsigned char[n];
+    unsigned char* changedNext = new unsigned char[n];
+    double* vertexEstimate = new double[n];
+    double* partial = new double[threads];
+    long long* partialChanged = new long long[threads];
+    long long* partialScanned = new long long[threads];
+    auto sum = [&]() {
+        for (int t = 0; t < threads; t++)
+            partial[t] = 0;
+        Parallel::forRange(0, n, threads, [&](int t, long long lo, long long hi) {
+            double s = 0;
+            for (long long v = lo; v < hi; v++)
+                s += vertexEstimate[v];
+            partial[t] = s;
+        });
+        double total = 0;
+        for (int t = 0; t < threads; t++)
+            total += partial[t];
+        return total;
+    };
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            unsigned long long z = seed + static_cast<unsigned long long>(v + 1) * 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+            int index = static_cast<int>(z >> (64 - registerBits));
+            unsigned long long rest = z << registerBits;
+            unsigned long long rank = rest == 0 ? 65 - registerBits : __builtin_clzll(rest) + 1;
+            unsigned long long* counter = current + v * words;
+            counter[index / 8] |= rank << (index % 8 * 8);
+            changed[v] = 1;
+            vertexEstimate[v] = estimate(counter, words);
+        }
+    });
+    nf[0] = sum();
+    int entries = 1;
+    const unsigned long long high = 0x8080808080808080ULL;
+    for (int t = 1; t <= maxDistance; t++) {
+        for (int i = 0; i < threads; i++)
+            partialChanged[i] = partialScanned[i] = 0;
+        Parallel::forDynamic(0, n, 256, threads, [&](int thread, long long lo, long long hi) {
+            long long count = 0;
+            long long scanned = 0;
+            for (long long v = lo; v < hi; v++) {
+                const unsigned long long* from = current + v * words;
+                unsigned long long* to = next + v * words;
+                for (int w = 0; w < words; w++)
+                    to[w] = from[w];
+                changedNext[v] = 0;
+                bool stale = false;
+                for (long long e = offsets[v]; e < offsets[v + 1] && !stale; e++)
+                    stale = changed[targets[e]] != 0;
+                if (!stale)
+                    continue;
+                bool grew = false;
+                for (long long e = offsets[v]; e < offsets[v + 1]; e++) {
+                    const unsigned long long* other = current + static_cast<long long>(targets[e]) * words;
+                    for (int w = 0; w < words; w++) {
+                        unsigned long long x = to[w];
+                        unsigned long long y = other[w];
+                        unsigned long long keep = ((((x | high) - y) & high) >> 7) * 0xFF;
+                        unsigned long long merged = (x & keep) | (y & ~keep);
+                        grew = grew || merged != x;
+                        to[w] = merged;
+                    }
+                }
+                scanned += offsets[v + 1] - offsets[v];
+                if (grew) {
+                    changedNext[v] = 1;
+                    vertexEstimate[v] = estimate(to, words);
+                    count++;
+                }
+            }
+            partialChanged[thread] += count;
+            partialScanned[thread] += scanned;
+        });
+        long long grown = 0;
+        for (int i = 0; i < threads; i++) {
+            grown += partialChanged[i];
+            GRAPH_COUNT(edgesScanned, partialScanned[i]);
+        }
+        if (grown == 0)
+            break;
+        nf[t] = sum();
+        entries++;
+        unsigned long long* swapCounters = current;
+        current = next;
+        next = swapCounters;
+        unsigned char* swapChanged = changed;
+        changed = changedNext;
+        changedNext = swapChanged;
+    }
+    delete[] current;
+    delete[] next;
+    delete[] changed;
+    delete[] changedNext;
+    delete[] vertexEstimate;
+    delete[] partial;
+    delete[] partialChanged;
+    delete[] partialScanned;
+    return entries;
+}
+
+int Distances::neighbourhoodFunction(const Graph& g, double* nf, int maxDistance, int registerBits,
+                                     unsigned long long seed, int threads) {
+    return neighbourhoodFunction(CSRGraph::fromGraph(g, threads), nf, maxDistance, registerBits, seed, threads);
+}
+
+// effectiveDiameter: linear interpolation between the two distances whose
+// pair counts straddle the target.
+double Distances::effectiveDiameter(const double* nf, int count, double fraction) {
+    if (count <= 0)
+        throw "Neighbourhood function is empty";
+    if (fraction <= 0 || fraction > 1)
+        throw "Fraction must be in (0, 1]";
+    double target = fraction * nf[count - 1];
+    int t = 0;
+    while (t < count - 1 && nf[t] < target)
+        t++;
+    if (t == 0 || nf[t] <= nf[t - 1])
+        return t;
+    return t - 1 + (target - nf[t - 1]) / (nf[t] - nf[t - 1]);
+}
+
+int Distances::sweep(const CSRGraph& g, int source, int* level, int* farthest, int threads) {
+    SpMV::bfsLevels(g, source, level, threads);
+    int n = g.getNumVertices();
+    int e = 0;
+    *farthest = source;
+    for (int v = 0; v < n; v++)
+        if (level[v] > e) {
+            e = level[v];
+            *farthest = v;
+        }
+    return e;
+}
+
+int Distances::midpoint(const CSRGraph& g, const int* level, int end) {
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    int v = end;
+    for (int steps = level[end] / 2; steps > 0; steps--) {
+        long long e = offsets[v];
+        while (level[targets[e]] != level[v] - 1)
+            e++;
+        v = targets[e];
+    }
+    return v;
+}
+
+// estimate: the raw HyperLogLog estimate, switching to linear counting for
+// small cardinalities while some register is still zero.
+double Distances::estimate(const unsigned long long* counter, int words) {
+    int m = words * 8;
+    double inverse = 0;
+    int zeros = 0;
+    for (int w = 0; w < words; w++)
+        for (int b = 0; b < 8; b++) {
+            int rank = static_cast<int>((counter[w] >> (b * 8)) & 0xFF);
+            inverse += std::ldexp(1.0, -rank);
+            if (rank == 0)
+                zeros++;
+        }
+    double alpha = m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+    double raw = alpha * m * m / inverse;
+    if (raw <= 2.5 * m && zeros > 0)
+        return m * std::log(static_cast<double>(m) / zeros);
+    return raw;
+}
+
+} // namespace graph
+
+#endif // DISTANCES_CPP
@@ -0,0 +1,598 @@
+// Flow.cpp
+#ifndef FLOW_CPP
+#define FLOW_CPP
+
+#include "Graph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace graph {
+
+// Directed residual network in CSR form. Every arc has a reverse arc in the
+// row of its head; an undirected edge becomes two arcs that are each other's
+// reverse, both with the edge's capacity, and a directed arc is paired with a
+// reverse arc of capacity 0. Self-loops are dropped.
+class FlowNetwork {
+public:
+    // Constructors, destructor, and assignment operator.
+    FlowNetwork(const FlowNetwork& other);
+    ~FlowNetwork();
+    FlowNetwork& operator=(FlowNetwork other); // Uses copy-swap idiom.
+    friend void swap(FlowNetwork& a, FlowNetwork& b);
+
+    // Conversions. Weights and capacities must be non-negative.
+    static FlowNetwork fromGraph(const Graph& g); // Undirected: capacity = weight.
+    static FlowNetwork fromArcs(int vertices, const int* src, const int* dst, const int* capacity,
+                                long long count);
+
+    // Accessors.
+    int getNumVertices() const;
+    long long getNumArcs() const;
+    const long long* getOffsets() const;
+    const int* getTargets() const;
+    const long long* getReverse() const;   // Index of each arc's reverse.
+    const long long* getCapacities() const;
+
+private:
+    int numVertices;
+    long long numArcs;
+    long long* offsets;
+    int* targets;
+    long long* reverse;
+    long long* capacities;
+
+    FlowNetwork(int vertices, long long arcs);
+    // Pairs arc src[i] -> dst[i] (capacity forward[i]) with its reverse (backward[i]).
+    static FlowNetwork build(int vertices, const int* src, const int* dst, const long long* forward,
+                             const long long* backward, long long count);
+};
+
+// Maximum flow / minimum cut by push-relabel. Both solvers stop after the
+// first phase (a maximum preflow): the flow value is the excess reaching
+// the sink, and the vertices that can no longer reach the sink in the
+// residual network form the source side of a minimum cut.
+class MaxFlow {
+public:
+    // Highest-label push-relabel with global relabeling and the gap heuristic.
+    // sourceSide (optional) receives the source side of a minimum cut.
+    static long long solve(const FlowNetwork& net, int source, int sink, bool* sourceSide = 0);
+    // Asynchronous parallel push-relabel: threads discharge vertices from a
+    // shared queue, locking both ends of each push; global relabels run
+    // between rounds.
+    static long long solveParallel(const FlowNetwork& net, int source, int sink, bool* sourceSide = 0,
+                                   int threads = 0);
+    // Undirected graph with weights as capacities; threads == 1 uses solve.
+    static long long minCut(const Graph& g, int source, int sink, bool* sourceSide = 0, int threads = 1);
+
+private:
+    static void checkTerminals(const FlowNetwork& net, int source, int sink);
+    // Exact distances to the sink in the residual network (n if it cannot be
+    // reached); the source is never labelled.
+    static void reverseBfs(const FlowNetwork& net, const long long* residual, int source, int sink,
+                           int* height, int* queue);
+    static void cutFrom(const FlowNetwork& net, const long long* residual, int source, int sink,
+                        bool* sourceSide);
+};
+
+FlowNetwork::FlowNetwork(int vertices, long long arcs) : numVertices(vertices), numArcs(arcs) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    offsets = new long long[numVertices + 1]();
+    targets = new int[numArcs];
+    reverse = new long long[numArcs];
+    capacities = new long long[numArcs];
+}
+
+FlowNetwork::~FlowNetwork() {
+    delete[] offsets;
+    delete[] targets;
+    delete[] reverse;
+    delete[] capacities;
+}
+
+FlowNetwork::FlowNetwork(const FlowNetwork& other) : numVertices(other.numVertices), numArcs(other.numArcs) {
+    offsets = new long long[numVertices + 1];
+    targets = new int[numArcs];
+    reverse = new long long[numArcs];
+    capacities = new long long[numArcs];
+    std::copy(other.offsets, other.offsets + numVertices + 1, offsets);
+    std::copy(other.targets, other.targets + numArcs, targets);
+    std::copy(other.reverse, other.reverse + numArcs, reverse);
+    std::copy(other.capacities, other.capacities + numArcs, capacities);
+}
+
+void swap(FlowNetwork& a, FlowNetwork& b) {
+    std::swap(a.numVertices, b.numVertices);
+    std::swap(a.numArcs, b.numArcs);
+    std::swap(a.offsets, b.offsets);
+    std::swap(a.targets, b.targets);
+    std::swap(a.reverse, b.reverse);
+    std::swap(a.capacities, b.capacities);
+}
+
+FlowNetwork& FlowNetwork::operator=(FlowNetwork other) {
+    swap(*this, other);
+    return *this;
+}
+
+// build: count both ends of every pair, prefix sum, then place each arc and
+// its reverse and point them at each other.
+FlowNetwork FlowNetwork::build(int vertices, const int* src, const int* dst, const long long* forward,
+                               const long long* backward, long long count) {
+    long long* cursor = new long long[vertices]();
+    long long arcs = 0;
+    for (long long i = 0; i < count; i++) {
+        if (src[i] == dst[i])
+            continue;
+        cursor[src[i]]++;
+        cursor[dst[i]]++;
+        arcs += 2;
+    }
+    FlowNetwork net(vertices, arcs);
+    for (int v = 0; v < vertices; v++) {
+        net.offsets[v + 1] = net.offsets[v] + cursor[v];
+        cursor[v] = net.offsets[v];
+    }
+    for (long long i = 0; i < count; i++) {
+        int u = src[i], v = dst[i];
+        if (u == v)
+            continue;
+        long long a = cursor[u]++, b = cursor[v]++;
+        net.targets[a] = v;
+        net.targets[b] = u;
+        net.reverse[a] = b;
+        net.reverse[b] = a;
+        net.capacities[a] = forward[i];
+        net.capacities[b] = backward[i];
+    }
+    delete[] cursor;
+    return net;
+}
+
+// fromGraph: each undirected edge appears in both lists; take it from the lower end.
+FlowNetwork FlowNetwork::fromGraph(const Graph& g) {
+    int n = g.getNumVertices();
+    long long count = 0;
+    for (int u = 0; u < n; u++)
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next) {
+            if (e->weight < 0)
+                throw "Negative capacity";
+            if (u < e->destination)
+                count++;
+        }
+    int* src = new int[count + 1];
+    int* dst = new int[count + 1];
+    long long* capacity = new long long[count + 1];
+    long long i = 0;
+    for (int u = 0; u < n; u++)
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next)
+            if (u < e->destination) {
+                src[i] = u;
+                dst[i] = e->destination;
+                capacity[i] = e->weight;
+                i++;
+            }
+    FlowNetwork net = build(n, src, dst, capacity, capacity, count);
+    delete[] src;
+    delete[] dst;
+    delete[] capacity;
+    return net;
+}
+
+FlowNetwork FlowNetwork::fromArcs(int vertices, const int* src, const int* dst, const int* capacity,
+                                  long long count) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    for (long long i = 0; i < count; i++) {
+        if (src[i] < 0 || src[i] >= vertices || dst[i] < 0 || dst[i] >= vertices)
+            throw "Vertex index out of range";
+        if (capacity[i] < 0)
+            throw "Negative capacity";
+    }
+    long long* forward = new long long[count + 1];
+    long long* backward = new long long[count + 1]();
+    for (long long i = 0; i < count; i++)
+        forward[i] = capacity[i];
+    FlowNetwork net = build(vertices, src, dst, forward, backward, count);
+    delete[] forward;
+    delete[] backward;
+    return net;
+}
+
+int FlowNetwork::getNumVertices() const {
+    return numVertices;
+}
+
+long long FlowNetwork::getNumArcs() const {
+    return numArcs;
+}
+
+const long long* FlowNetwork::getOffsets() const {
+    return offsets;
+}
+
+const int* FlowNetwork::getTargets() const {
+    return targets;
+}
+
+const long long* FlowNetwork::getReverse() const {
+    return reverse;
+}
+
+const long long* FlowNetwork::getCapacities() const {
+    return capacities;
+}
+
+void MaxFlow::checkTerminals(const FlowNetwork& net, int source, int sink) {
+    int n = net.getNumVertices();
+    if (source < 0 || source >= n || sink < 0 || sink >= n)
+        throw "Vertex index out of range";
+    if (source == sink)
+        throw "Source and sink must differ";
+}
+
+// reverseBfs: from the sink along arcs whose reverse still has residual capacity.
+void MaxFlow::reverseBfs(const FlowNetwork& net, const long long* residual, int source, int sink,
+                         int* height, int* queue) {
+    int n = net.getNumVertices();
+    const long long* offsets = net.getOffsets();
+    const int* targets = net.getTargets();
+    const long long* reverse = net.getReverse();
+    for (int v = 0; v < n; v++)
+        height[v] = n;
+    height[sink] = 0;
+    queue[0] = sink;
+    int tail = 1;
+    for (int head = 0; head < tail; head++) {
+        int w = queue[head];
+        for (long long a = offsets[w]; a < offsets[w + 1]; a++) {
+            int v = targets[a];
+            if (height[v] == n && v != source && residual[reverse[a]] > 0) {
+                height[v] = height[w] + 1;
+                queue[tail++] = v;
+            }
+        }
+    }
+}
+
+void MaxFlow::cutFrom(const FlowNetwork& net, const long long* residual, int source, int sink,
+                      bool* sourceSide) {
+    if (!sourceSide)
+        return;
+    int n = net.getNumVertices();
+    int* height = new int[n];
+    int* queue = new int[n];
+    reverseBfs(net, residual, source, sink, height, queue);
+    for (int v = 0; v < n; v++)
+        sourceSide[v] = height[v] == n;
+    delete[] height;
+    delete[] queue;
+}
+
+// solve: active vertices wait in buckets by height and the highest is
+// discharged first. Every vertex below n also sits in a doubly linked list
+// for its height, so when a relabel empties a height (a gap) everything
+// above it is lifted to n at once. A global relabel (exact heights by
+// reverse BFS) runs at the start and whenever relabel work passes 6n + m.
+long long MaxFlow::solve(const FlowNetwork& net, int source, int sink, bool* sourceSide) {
+    checkTerminals(net, source, sink);
+    GRAPH_INSTRUMENT_SCOPE("max_flow");
+    int n = net.getNumVertices();
+    long long arcs = net.getNumArcs();
+    const long long* offsets = net.getOffsets();
+    const int* targets = net.getTargets();
+    const long long* reverse = net.getReverse();
+    long long* residual = new long long[arcs];
+    std::copy(net.getCapacities(), net.getCapacities() + arcs, residual);
+    long long* excess = new long long[n]();
+    int* height = new int[n];
+    long long* current = new long long[n];
+    int* queue = new int[n];
+    int* activeHead = new int[n];
+    int* activeNext = new int[n];
+    int* levelHead = new int[n];
+    int* levelNext = new int[n];
+    int* levelPrev = new int[n];
+    int maxActive = -1, maxHeight = -1;
+    long long work = 0, workLimit = 6LL * n + arcs / 2;
+
+    auto activate = [&](int v) {
+        activeNext[v] = activeHead[height[v]];
+        activeHead[height[v]] = v;
+        if (height[v] > maxActive)
+            maxActive = height[v];
+    };
+    auto link = [&](int v) {
+        int h = height[v];
+        levelPrev[v] = -1;
+        levelNext[v] = levelHead[h];
+        if (levelHead[h] >= 0)
+            levelPrev[levelHead[h]] = v;
+        levelHead[h] = v;
+        if (h > maxHeight)
+            maxHeight = h;
+    };
+    auto unlink = [&](int v) {
+        if (levelPrev[v] >= 0)
+            levelNext[levelPrev[v]] = levelNext[v];
+        else
+            levelHead[height[v]] = levelNext[v];
+        if (levelNext[v] >= 0)
+            levelPrev[levelNext[v]] = levelPrev[v];
+    };
+    auto globalRelabel = [&]() {
+        reverseBfs(net, residual, source, sink, height, queue);
+        for (int h = 0; h < n; h++)
+            activeHead[h] = levelHead[h] = -1;
+        maxActive = maxHeight = -1;
+        for (int v = 0; v < n; v++) {
+            current[v] = offsets[v];
+            if (height[v] >= n)
+                continue;
+            link(v);
+            if (excess[v] > 0 && v != sink)
+                activate(v);
+        }
+        work = 0;
+    };
+
+    for (long long a = offsets[source]; a < offsets[source + 1]; a++) {
+        long long c = residual[a];
+        residual[a] = 0;
+        residual[reverse[a]] += c;
+        excess[targets[a]] += c;
+        excess[source] -= c;
+    }
+    globalRelabel();
+    while (maxActive >= 0) {
+        int v = activeHead[maxActive];
+        if (v < 0) {
+            maxActive--;
+            continue;
+        }
+        activeHead[maxActive] = activeNext[v];
+        if (height[v] != maxActive)
+            continue; // Lifted by a gap since it was queued.
+        // Discharge v: push along admissible arcs, relabel when none is left.
+        int h = height[v];
+        while (excess[v] > 0) {
+            long long a = current[v], end = offsets[v + 1];
+            for (; a < end; a++) {
+                int w = targets[a];
+                if (residual[a] == 0 || height[w] != h - 1)
+                    continue;
+                long long delta = excess[v] < residual[a] ? excess[v] : residual[a];
+                residual[a] -= delta;
+                residual[reverse[a]] += delta;
+                excess[v] -= delta;
+                if (excess[w] == 0 && w != sink)
+                    activate(w);
+                excess[w] += delta;
+                if (excess[v] == 0)
+                    break;
+            }
+            if (excess[v] == 0) {
+                current[v] = a;
+                break;
+            }
+            int newHeight = n;
+            long long newCurrent = offsets[v];
+            for (long long b = offsets[v]; b < end; b++)
+                if (residual[b] > 0 && height[targets[b]] + 1 < newHeight) {
+                    newHeight = height[targets[b]] + 1;
+                    newCurrent = b;
+                }
+            work += 12 + end - offsets[v];
+            unlink(v);
+            if (levelHead[h] < 0) {
+                // Gap: nothing at height h any more, so nothing above reaches the sink.
+                for (int above = h + 1; above <= maxHeight; above++) {
+                    for (int x = levelHead[above]; x >= 0; x = levelNext[x])
+                        height[x] = n;
+                    levelHead[above] = -1;
+                }
+                maxHeight = h - 1;
+                height[v] = n;
+                break;
+            }
+            height[v] = newHeight;
+            if (newHeight >= n)
+                break;
+            link(v);
+            current[v] = newCurrent;
+            h = newHeight;
+        }
+        if (work > workLimit)
+            globalRelabel();
+    }
+    long long flow = excess[sink];
+    cutFrom(net, residual, source, sink, sourceSide);
+    delete[] residual;
+    delete[] excess;
+    delete[] height;
+    delete[] current;
+    delete[] queue;
+    delete[] activeHead;
+    delete[] activeNext;
+    delete[] levelHead;
+    delete[] levelNext;
+    delete[] levelPrev;
+    return flow;
+}
+
+// solveParallel: a push from v to w holds the spin locks of both (taken in
+// id order) and a relabel holds v's, which keeps the labelling valid under
+// any interleaving. A vertex is queued at most once: 'queued' is set when
+// its excess becomes positive and cleared, under its lock, once a discharge
+// leaves it empty. Threads stop taking work when relabel work passes the
+// global relabel threshold; the relabel then runs alone and the queue is
+// rebuilt from the active vertices.
+long long MaxFlow::solveParallel(const FlowNetwork& net, int source, int sink, bool* sourceSide, int threads) {
+    checkTerminals(net, source, sink);
+    GRAPH_INSTRUMENT_SCOPE("max_flow_parallel");
+    int n = net.getNumVertices();
+    long long arcs = net.getNumArcs();
+    const long long* offsets = net.getOffsets();
+    const int* targets = net.getTargets();
+    const long long* reverse = net.getReverse();
+    threads = Parallel::resolve(threads);
+    long long* residual = new long long[arcs];
+    std::copy(net.getCapacities(), net.getCapacities() + arcs, residual);
+    long long* excess = new long long[n]();
+    std::atomic<int>* height = new std::atomic<int>[n];
+    int* exact = new int[n];
+    bool* queued = new bool[n]();
+    std::atomic_flag* locks = new std::atomic_flag[n];
+    for (int v = 0; v < n; v++)
+        locks[v].clear();
+    int* queue = new int[n]; // Ring buffer; each vertex is in it at most once.
+    long long queueHead = 0, queueSize = 0;
+    int busy = 0;
+    bool stop = false;
+    std::atomic<long long> work(0);
+    long long workLimit = 6LL * n + arcs / 2;
+    std::mutex queueLock;
+    std::condition_variable queueReady;
+
+    auto lock = [&](int v) {
+        while (locks[v].test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+    };
+    auto unlock = [&](int v) { locks[v].clear(std::memory_order_release); };
+    auto enqueue = [&](int v) { // Caller holds queueLock.
+        queue[(queueHead + queueSize++) % n] = v;
+    };
+    auto globalRelabel = [&]() {
+        reverseBfs(net, residual, source, sink, exact, queue);
+        queueHead = queueSize = 0;
+        for (int v = 0; v < n; v++) {
+            height[v].store(exact[v], std::memory_order_relaxed);
+            queued[v] = excess[v] > 0 && v != sink && exact[v] < n;
+            if (queued[v])
+                enqueue(v);
+        }
+        work.store(0, std::memory_order_relaxed);
+    };
+    // discharge: returns with v's excess gone or v lifted to n; newly active
+    // neighbours go to 'woken' and are queued by the caller.
+    auto discharge = [&](int v, int* woken, int& numWoken) {
+        long long next = offsets[v];
+        while (true) {
+            int h = height[v].load(std::memory_order_relaxed);
+            bool emptied = false;
+            for (; next < offsets[v + 1] && !emptied; next++) {
+                int w = targets[next];
+                if (height[w].load(std::memory_order_relaxed) != h - 1)
+                    continue;
+                int first = v < w ? v : w, second = v < w ? w : v;
+                lock(first);
+                lock(second);
+                if (residual[next] > 0 && excess[v] > 0 && height[w].load(std::memory_order_relaxed) == h - 1) {
+                    long long delta = excess[v] < residual[next] ? excess[v] : residual[next];
+                    residual[next] -= delta;
+                    residual[reverse[next]] += delta;
+                    excess[v] -= delta;
+                    excess[w] += delta;
+                    if (w != sink && !queued[w]) {
+                        queued[w] = true;
+                        woken[numWoken++] = w;
+                    }
+                }
+                emptied = excess[v] == 0;
+                unlock(second);
+                unlock(first);
+            }
+            lock(v);
+            if (excess[v] == 0) {
+                queued[v] = false;
+                unlock(v);
+                return;
+            }
+            // Relabel under v's lock: no residual arc out of v can appear
+            // meanwhile, and the other heights only grow.
+            int newHeight = n;
+            for (long long b = offsets[v]; b < offsets[v + 1]; b++)
+                if (residual[b] > 0) {
+                    int candidate = height[targets[b]].load(std::memory_order_relaxed) + 1;
+                    if (candidate < newHeight)
+                        newHeight = candidate;
+                }
+            work.fetch_add(12 + offsets[v + 1] - offsets[v], std::memory_order_relaxed);
+            if (newHeight > h)
+                height[v].store(newHeight, std::memory_order_relaxed);
+            if (newHeight >= n) {
+                queued[v] = false; // Cannot reach the sink; leaves its excess.
+                unlock(v);
+                return;
+            }
+            unlock(v);
+            next = offsets[v];
+        }
+    };
+    auto worker = [&](int, long long, long long) {
+        int* woken = new int[n];
+        std::unique_lock<std::mutex> guard(queueLock);
+        while (true) {
+            while (queueSize == 0 && busy > 0 && !stop)
+                queueReady.wait(guard);
+            if (stop || queueSize == 0)
+                break;
+            int v = queue[queueHead];
+            queueHead = (queueHead + 1) % n;
+            queueSize--;
+            busy++;
+            guard.unlock();
+            int numWoken = 0;
+            discharge(v, woken, numWoken);
+            guard.lock();
+            busy--;
+            for (int i = 0; i < numWoken; i++)
+                enqueue(woken[i]);
+            if (work.load(std::memory_order_relaxed) > workLimit)
+                stop = true;
+            queueReady.notify_all();
+        }
+        queueReady.notify_all();
+        delete[] woken;
+    };
+
+    for (long long a = offsets[source]; a < offsets[source + 1]; a++) {
+        long long c = residual[a];
+        residual[a] = 0;
+        residual[reverse[a]] += c;
+        excess[targets[a]] += c;
+        excess[source] -= c;
+    }
+    globalRelabel();
+    while (queueSize > 0) {
+        stop = false;
+        Parallel::forRange(0, threads, threads, worker);
+        if (stop)
+            globalRelabel();
+    }
+    long long flow = excess[sink];
+    cutFrom(net, residual, source, sink, sourceSide);
+    delete[] residual;
+    delete[] excess;
+    delete[] height;
+    delete[] exact;
+    delete[] queued;
+    delete[] locks;
+    delete[] queue;
+    return flow;
+}
+
+long long MaxFlow::minCut(const Graph& g, int source, int sink, bool* sourceSide, int threads) {
+    FlowNetwork net = FlowNetwork::fromGraph(g);
+    if (threads == 1)
+        return solve(net, source, sink, sourceSide);
+    return solveParallel(net, source, sink, sourceSide, threads);
+}
+
+} // namespace graph
+
+#endif // FLOW_CPP
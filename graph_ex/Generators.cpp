@@ -0,0 +1,315 @@
+// Generators.cpp
+#ifndef GENERATORS_CPP
+#define GENERATORS_CPP
+
+#include "CSRGraph.cpp"
+#include <cmath>
+
+namespace graph {
+
+// Synthetic graph generators. Every edge (or vertex) draws from its own
+// counter-based random stream, so the output for a given seed is identical
+// regardless of the number of threads. Results are emitted as CSR directly.
+class Generators {
+public:
+    // R-MAT with quadrant probabilities a, b, c (d = 1 - a - b - c):
+    // 2^scale vertices and edgeFactor * 2^scale edges.
+    static CSRGraph rmat(int scale, int edgeFactor, double a, double b, double c,
+                         unsigned long long seed, int maxWeight = 1, int threads = 0);
+    // Graph500 Kronecker: R-MAT(0.57, 0.19, 0.19) with randomly permuted vertex labels.
+    static CSRGraph kronecker(int scale, int edgeFactor, unsigned long long seed,
+                              int maxWeight = 1, int threads = 0);
+    // rows x cols 4-neighbour lattice; each edge is dropped with 'dropProbability'
+    // (a small value gives a road-like network).
+    static CSRGraph grid(int rows, int cols, double dropProbability, unsigned long long seed,
+                         int maxWeight = 1, int threads = 0);
+    // Erdos-Renyi G(n, m): m edges with uniformly random distinct endpoints.
+    static CSRGraph erdosRenyi(int vertices, long long edges, unsigned long long seed,
+                               int maxWeight = 1, int threads = 0);
+    // Random geometric graph: points in the unit square, joined when at most
+    // 'radius' apart; weights grow with distance from 1 to maxWeight.
+    static CSRGraph randomGeometric(int vertices, double radius, unsigned long long seed,
+                                    int maxWeight = 1, int threads = 0);
+
+private:
+    // SplitMix64 stream keyed by (seed, stream).
+    struct Random {
+        unsigned long long state;
+        Random(unsigned long long seed, unsigned long long stream)
+            : state(seed ^ (stream * 0x9E3779B97F4A7C15ULL + 0xD1B54A32D192ED03ULL)) {
+            next();
+        }
+        unsigned long long next() {
+            unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+        double nextDouble() {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+        int nextInt(int bound) {
+            return static_cast<int>(next() % static_cast<unsigned long long>(bound));
+        }
+    };
+    static CSRGraph rmatImpl(int scale, int edgeFactor, double a, double b, double c,
+                             unsigned long long seed, int maxWeight, bool permute, int threads);
+    // Two-pass emission for generators where vertex v lists its edges to higher ids:
+    // count(v) returns how many edges v emits, fill(v, src, dst, weight) writes them.
+    template <typename Count, typename Fill>
+    static CSRGraph emitByVertex(int vertices, int threads, Count count, Fill fill);
+};
+
+CSRGraph Generators::rmat(int scale, int edgeFactor, double a, double b, double c,
+                          unsigned long long seed, int maxWeight, int threads) {
+    return rmatImpl(scale, edgeFactor, a, b, c, seed, maxWeight, false, threads);
+}
+
+CSRGraph Generators::kronecker(int scale, int edgeFactor, unsigned long long seed,
+                               int maxWeight, int threads) {
+    return rmatImpl(scale, edgeFactor, 0.57, 0.19, 0.19, seed, maxWeight, true, threads);
+}
+
+CSRGraph Generators::rmatImpl(int scale, int edgeFactor, double a, double b, double c,
+                              unsigned long long seed, int maxWeight, bool permute, int threads) {
+    if (scale < 1 || scale > 30)
+        throw "Scale must be between 1 and 30";
+    if (edgeFactor <= 0)
+        throw "Edge factor must be positive";
+    if (a < 0 || b < 0 || c < 0 || a + b + c > 1.0)
+        throw "Invalid R-MAT probabilities";
+    if (maxWeight <= 0)
+        throw "Maximum weight must be positive";
+    int n = 1 << scale;
+    long long m = static_cast<long long>(edgeFactor) << scale;
+    int* perm = 0;
+    if (permute) {
+        // Fisher-Yates on a dedicated stream so labels do not correlate with edges.
+        perm = new int[n];
+        for (int i = 0; i < n; i++)
+            perm[i] = i;
+        Random r(seed, ~0ULL);
+        for (int i = n - 1; i > 0; i--) {
+            int j = r.nextInt(i + 1);
+            int tmp = perm[i];
+            perm[i] = perm[j];
+            perm[j] = tmp;
+        }
+    }
+    int* src = new int[m];
+    int* dst = new int[m];
+    int* w = new int[m];
+    double ab = a + b, abc = a + b + c;
+    Parallel::forRange(0, m, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++) {
+            Random r(seed, static_cast<unsigned long long>(i));
+            int u = 0, v = 0;
+            for (int bit = 1 << (scale - 1); bit != 0; bit >>= 1) {
+                double p = r.nextDouble();
+                if (p < a)
+                    continue; // Top-left quadrant: neither bit is set.
+                if (p < ab)
+                    v |= bit;
+                else if (p < abc)
+                    u |= bit;
+                else {
+                    u |= bit;
+                    v |= bit;
+                }
+            }
+            src[i] = perm ? perm[u] : u;
+            dst[i] = perm ? perm[v] : v;
+            w[i] = 1 + r.nextInt(maxWeight);
+        }
+    });
+    delete[] perm;
+    CSRGraph csr = CSRGraph::fromEdges(n, src, dst, w, m, threads);
+    delete[] src;
+    delete[] dst;
+    delete[] w;
+    return csr;
+}
+
+template <typename Count, typename Fill>
+CSRGraph Generators::emitByVertex(int vertices, int threads, Count count, Fill fill) {
+    long long* start = new long long[vertices + 1]();
+    Parallel::forRange(0, vertices, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++)
+            start[v + 1] = count(static_cast<int>(v));
+    });
+    for (int v = 0; v < vertices; v++)
+        start[v + 1] += start[v];
+    long long m = start[vertices];
+    int* src = new int[m];
+    int* dst = new int[m];
+    int* w = new int[m];
+    Parallel::forRange(0, vertices, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            long long p = start[v];
+            fill(static_cast<int>(v), src + p, dst + p, w + p);
+        }
+    });
+    delete[] start;
+    CSRGraph csr = CSRGraph::fromEdges(vertices, src, dst, w, m, threads);
+    delete[] src;
+    delete[] dst;
+    delete[] w;
+    return csr;
+}
+
+CSRGraph Generators::grid(int rows, int cols, double dropProbability, unsigned long long seed,
+                          int maxWeight, int threads) {
+    if (rows <= 0 || cols <= 0)
+        throw "Grid dimensions must be positive";
+    if (static_cast<long long>(rows) * cols > 2147483647LL)
+        throw "Grid is too large";
+    if (dropProbability < 0 || dropProbability >= 1.0)
+        throw "Drop probability must be in [0, 1)";
+    if (maxWeight <= 0)
+        throw "Maximum weight must be positive";
+    // Lattice edge 2v goes right from v, edge 2v + 1 goes down from v.
+    auto keep = [=](int v, int dir, int& weight) -> bool {
+        int r = v / cols, c = v % cols;
+        if ((dir == 0 && c + 1 >= cols) || (dir == 1 && r + 1 >= rows))
+            return false;
+        Random rnd(seed, 2ULL * static_cast<unsigned long long>(v) + dir);
+        if (rnd.nextDouble() < dropProbability)
+            return false;
+        weight = 1 + rnd.nextInt(maxWeight);
+        return true;
+    };
+    return emitByVertex(rows * cols, threads,
+        [&](int v) -> long long {
+            int w;
+            return (keep(v, 0, w) ? 1 : 0) + (keep(v, 1, w) ? 1 : 0);
+        },
+        [&](int v, int* s, int* d, int* wt) {
+            int k = 0, w;
+            if (keep(v, 0, w)) {
+                s[k] = v; d[k] = v + 1; wt[k] = w; k++;
+            }
+            if (keep(v, 1, w)) {
+                s[k] = v; d[k] = v + cols; wt[k] = w;
+            }
+        });
+}
+
+CSRGraph Generators::erdosRenyi(int vertices, long long edges, unsigned long long seed,
+                                int maxWeight, int threads) {
+    if (vertices < 2)
+        throw "Erdos-Renyi graph needs at least two vertices";
+    if (edges < 0)
+        throw "Number of edges must be non-negative";
+    if (maxWeight <= 0)
+        throw "Maximum weight must be positive";
+    int* src = new int[edges];
+    int* dst = new int[edges];
+    int* w = new int[edges];
+    Parallel::forRange(0, edges, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++) {
+            Random r(seed, static_cast<unsigned long long>(i));
+            int u = r.nextInt(vertices);
+            int v = r.nextInt(vertices - 1);
+            if (v >= u)
+                v++;
+            src[i] = u;
+            dst[i] = v;
+            w[i] = 1 + r.nextInt(maxWeight);
+        }
+    });
+    CSRGraph csr = CSRGraph::fromEdges(vertices, src, dst, w, edges, threads);
+    delete[] src;
+    delete[] dst;
+    delete[] w;
+    return csr;
+}
+
+CSRGraph Generators::randomGeometric(int vertices, double radius, unsigned long long seed,
+                                     int maxWeight, int threads) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    if (!(radius > 0) || radius > 1.5)
+        throw "Radius must be in (0, 1.5]";
+    if (maxWeight <= 0)
+        throw "Maximum weight must be positive";
+    double* x = new double[vertices];
+    double* y = new double[vertices];
+    Parallel::forRange(0, vertices, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++) {
+            Random r(seed, static_cast<unsigned long long>(i));
+            x[i] = r.nextDouble();
+            y[i] = r.nextDouble();
+        }
+    });
+    // Bucket points into square cells of side >= radius (counting sort by cell).
+    long long side = static_cast<long long>(1.0 / radius);
+    long long maxSide = static_cast<long long>(std::sqrt(static_cast<double>(vertices))) + 1;
+    if (side > maxSide)
+        side = maxSide;
+    if (side < 1)
+        side = 1;
+    int cells = static_cast<int>(side * side);
+    int* cellOf = new int[vertices];
+    int* cellStart = new int[cells + 1]();
+    int* byCell = new int[vertices];
+    for (int i = 0; i < vertices; i++) {
+        int cx = static_cast<int>(x[i] * side), cy = static_cast<int>(y[i] * side);
+        cellOf[i] = cy * static_cast<int>(side) + cx;
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < cells; c++)
+        cellStart[c + 1] += cellStart[c];
+    int* fillPos = new int[cells];
+    for (int c = 0; c < cells; c++)
+        fillPos[c] = cellStart[c];
+    for (int i = 0; i < vertices; i++)
+        byCell[fillPos[cellOf[i]]++] = i;
+    delete[] fillPos;
+    int s = static_cast<int>(side);
+    double r2 = radius * radius;
+    // Visit the 3x3 block of cells around v and report neighbours with a higher id.
+    auto scan = [&](int v, int* d, int* wt) -> long long {
+        long long k = 0;
+        int cx = cellOf[v] % s, cy = cellOf[v] / s;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = cx + dx, ny = cy + dy;
+                if (nx < 0 || ny < 0 || nx >= s || ny >= s)
+                    continue;
+                int c = ny * s + nx;
+                for (int p = cellStart[c]; p < cellStart[c + 1]; p++) {
+                    int u = byCell[p];
+                    if (u <= v)
+                        continue;
+                    double ddx = x[u] - x[v], ddy = y[u] - y[v];
+                    double dd = ddx * ddx + ddy * ddy;
+                    if (dd > r2)
+                        continue;
+                    if (d) {
+                        d[k] = u;
+                        wt[k] = 1 + static_cast<int>((maxWeight - 1) * (std::sqrt(dd) / radius));
+                    }
+                    k++;
+                }
+            }
+        }
+        return k;
+    };
+    CSRGraph csr = emitByVertex(vertices, threads,
+        [&](int v) -> long long { return scan(v, 0, 0); },
+        [&](int v, int* src, int* dst, int* wt) {
+            long long k = scan(v, dst, wt);
+            for (long long i = 0; i < k; i++)
+                src[i] = v;
+        });
+    delete[] x;
+    delete[] y;
+    delete[] cellOf;
+    delete[] cellStart;
+    delete[] byCell;
+    return csr;
+}
+
+} // namespace graph
+
+#endif // GENERATORS_CPP
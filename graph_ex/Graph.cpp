@@ -2,6 +2,9 @@
 #ifndef GRAPH_CPP
 #define GRAPH_CPP
 
+#include "Parallel.cpp"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 
 namespace graph {
@@ -13,53 +16,219 @@ public:
         int destination;
         int weight;
         Edge* next;
-        
+
         Edge(int dest, int w) : destination(dest), weight(w), next(0) {}
         // Destructor is empty; cleanup is handled by Graph.
         ~Edge() {}
     };
 
+    // One undirected edge of a batch passed to addEdges.
+    struct EdgeTriple {
+        int source;
+        int dest;
+        int weight;
+    };
+
     // Constructors, destructor, and assignment operator.
+    // Copies share every adjacency list with the original; a list is copied
+    // the first time either graph modifies it, so copy-then-edit costs O(V)
+    // pointer copies plus the edited lists instead of O(E) edge allocations.
+    // Edge pointers obtained from getAdjList are invalidated by any change.
     Graph(int vertices);
     ~Graph();
     Graph(const Graph& other);
-    Graph& operator=(Graph other); // Uses copy-swap idiom.
+    Graph(Graph&& other) noexcept; // Leaves 'other' empty: destroy or assign only.
+    Graph& operator=(Graph other); // Uses copy-swap idiom (moves rvalues).
     friend void swap(Graph& a, Graph& b);
 
     // Graph operations.
     void addEdge(int source, int dest, int weight = 1);
+    // Bulk insert: same result as calling addEdge for each triple in order,
+    // but each touched list is walked once. With dedup, an edge whose endpoints
+    // are already adjacent (in the graph or earlier in the batch) is skipped.
+    void addEdges(const EdgeTriple* edges, long long count, bool dedup = false, int threads = 0);
     void removeEdge(int source, int dest);
     void print_graph() const;
 
+    // Edge lookups (the first edge between the endpoints when there are several).
+    bool hasEdge(int source, int dest) const;
+    int getWeight(int source, int dest) const;
+    void updateWeight(int source, int dest, int weight);
+
+    // Vertices whose degree exceeds the threshold get a hash index over their
+    // neighbours, making the lookups above and removeEdge expected O(1).
+    // A threshold of 0 (the default) disables indexing.
+    void setIndexThreshold(int threshold);
+    int getIndexThreshold() const;
+
     // Accessors.
     int getNumVertices() const;
+    int getDegree(int vertex) const;
     Edge* getAdjList(int vertex) const;
 
 private:
-    Edge** adjacencyList; // Array of pointers to linked lists.
+    // Open-addressing (linear probing) hash from a destination to the slot,
+    // i.e. the head pointer or a predecessor's next field, that holds the
+    // first edge to that destination.
+    struct NeighborIndex {
+        int* keys;      // -1 marks an empty bucket.
+        Edge*** slots;
+        int* counts;    // Number of parallel edges to the key.
+        int capacity;   // Power of two, at least twice the size.
+        int size;
+
+        NeighborIndex(int expected);
+        ~NeighborIndex();
+        int bucketOf(int key) const;
+        int find(int key) const;           // Bucket holding key, or -1.
+        void insert(int key, Edge** slot); // New key, or one more parallel edge.
+        void erase(int bucket);            // Backward-shift deletion.
+        void rehash(int newCapacity);
+    };
+
+    // Per-vertex list, shared between copies of a graph until one writes it.
+    struct VertexList {
+        Edge* head;
+        Edge** tail;          // Slot holding the list's terminating null pointer.
+        int degree;
+        NeighborIndex* index; // Only for vertices above the threshold.
+        std::atomic<int> refs; // Graphs holding this list (copies may live on other threads).
+
+        VertexList() : head(0), tail(&head), degree(0), index(0), refs(1) {}
+    };
+
+    VertexList** adjacencyList; // One list per vertex; null until the first edge.
     int numVertices;
-    
+    int indexThreshold;
+
     // Helper functions.
-    Edge* deepCopyEdgeList(Edge* head) const; // Iterative deep copy.
+    void deepCopyEdgeList(const VertexList& from, VertexList& to) const; // Iterative deep copy.
     void freeEdgeList(Edge* head);            // Iterative deletion.
+    void releaseList(VertexList* list);       // Drop one reference.
+    VertexList& mutableList(int vertex);      // Unshares the list before a write.
+    void buildIndex(VertexList& list);
+    void appendEdge(VertexList& list, Edge* edge);  // O(1) append at the tail.
+    void unlinkEdge(VertexList& list, Edge** slot); // Remove and delete *slot.
+    Edge** findSlot(VertexList& list, int to);
+    Edge* findEdge(int from, int to) const;
 };
 
-// Constructor: allocate the array for adjacency lists.
-Graph::Graph(int vertices) : numVertices(vertices) {
+// --- NeighborIndex ---
+
+Graph::NeighborIndex::NeighborIndex(int expected) : capacity(16), size(0) {
+    while (capacity < 2 * expected)
+        capacity *= 2;
+    keys = new int[capacity];
+    slots = new Edge**[capacity];
+    counts = new int[capacity];
+    for (int i = 0; i < capacity; i++)
+        keys[i] = -1;
+}
+
+Graph::NeighborIndex::~NeighborIndex() {
+    delete[] keys;
+    delete[] slots;
+    delete[] counts;
+}
+
+// Multiplicative hashing; the multiplier is odd, so consecutive ids never collide.
+int Graph::NeighborIndex::bucketOf(int key) const {
+    return static_cast<int>((static_cast<unsigned int>(key) * 2654435761u) & static_cast<unsigned int>(capacity - 1));
+}
+
+int Graph::NeighborIndex::find(int key) const {
+    for (int b = bucketOf(key); keys[b] != -1; b = (b + 1) & (capacity - 1))
+        if (keys[b] == key)
+            return b;
+    return -1;
+}
+
+void Graph::NeighborIndex::insert(int key, Edge** slot) {
+    if (2 * (size + 1) > capacity)
+        rehash(capacity * 2);
+    int b = bucketOf(key);
+    while (keys[b] != -1) {
+        if (keys[b] == key) {
+            counts[b]++; // A later parallel edge; the first one stays indexed.
+            return;
+        }
+        b = (b + 1) & (capacity - 1);
+    }
+    keys[b] = key;
+    slots[b] = slot;
+    counts[b] = 1;
+    size++;
+}
+
+void Graph::NeighborIndex::erase(int bucket) {
+    keys[bucket] = -1;
+    size--;
+    // Pull later entries of the probe run back so lookups never stop early.
+    int hole = bucket;
+    for (int j = (hole + 1) & (capacity - 1); keys[j] != -1; j = (j + 1) & (capacity - 1)) {
+        int home = bucketOf(keys[j]);
+        bool movable = hole <= j ? (home <= hole || home > j) : (home <= hole && home > j);
+        if (movable) {
+            keys[hole] = keys[j];
+            slots[hole] = slots[j];
+            counts[hole] = counts[j];
+            keys[j] = -1;
+            hole = j;
+        }
+    }
+}
+
+void Graph::NeighborIndex::rehash(int newCapacity) {
+    int* oldKeys = keys;
+    Edge*** oldSlots = slots;
+    int* oldCounts = counts;
+    int oldCapacity = capacity;
+    capacity = newCapacity;
+    keys = new int[capacity];
+    slots = new Edge**[capacity];
+    counts = new int[capacity];
+    for (int i = 0; i < capacity; i++)
+        keys[i] = -1;
+    for (int i = 0; i < oldCapacity; i++) {
+        if (oldKeys[i] == -1)
+            continue;
+        int b = bucketOf(oldKeys[i]);
+        while (keys[b] != -1)
+            b = (b + 1) & (capacity - 1);
+        keys[b] = oldKeys[i];
+        slots[b] = oldSlots[i];
+        counts[b] = oldCounts[i];
+    }
+    delete[] oldKeys;
+    delete[] oldSlots;
+    delete[] oldCounts;
+}
+
+// --- Graph ---
+
+// Constructor: allocate the array for adjacency lists (all empty).
+Graph::Graph(int vertices) : numVertices(vertices), indexThreshold(0) {
     if (vertices <= 0)
         throw "Number of vertices must be positive";
-    adjacencyList = new Edge*[numVertices];
-    for (int i = 0; i < numVertices; ++i)
-        adjacencyList[i] = 0;
+    adjacencyList = new VertexList*[numVertices]();
 }
 
-// Destructor: free each edge list.
+// Destructor: release each edge list.
 Graph::~Graph() {
     for (int i = 0; i < numVertices; ++i)
-        freeEdgeList(adjacencyList[i]);
+        releaseList(adjacencyList[i]);
     delete [] adjacencyList;
 }
 
+// Helper: free a list once the last graph holding it lets go.
+void Graph::releaseList(VertexList* list) {
+    if (list && --list->refs == 0) {
+        freeEdgeList(list->head);
+        delete list->index;
+        delete list;
+    }
+}
+
 // Helper: iteratively free a linked list of edges.
 void Graph::freeEdgeList(Edge* head) {
     while (head) {
@@ -69,26 +238,48 @@ void Graph::freeEdgeList(Edge* head) {
     }
 }
 
-// Iterative deep-copy of an edge list.
-Graph::Edge* Graph::deepCopyEdgeList(Edge* head) const {
-    if (!head)
-        return 0;
-    Edge* newHead = new Edge(head->destination, head->weight);
-    Edge* copyTail = newHead;
-    head = head->next;
-    while (head) {
-        copyTail->next = new Edge(head->destination, head->weight);
-        copyTail = copyTail->next;
-        head = head->next;
+// Iterative deep-copy of an edge list into an empty one (the index is not copied).
+void Graph::deepCopyEdgeList(const VertexList& from, VertexList& to) const {
+    to.degree = from.degree;
+    for (Edge* curr = from.head; curr != 0; curr = curr->next) {
+        *to.tail = new Edge(curr->destination, curr->weight);
+        to.tail = &(*to.tail)->next;
     }
-    return newHead;
 }
 
-// Copy constructor.
-Graph::Graph(const Graph& other) : numVertices(other.numVertices) {
-    adjacencyList = new Edge*[numVertices];
-    for (int i = 0; i < numVertices; ++i)
-        adjacencyList[i] = deepCopyEdgeList(other.adjacencyList[i]);
+// Copy constructor: share every list with the original.
+Graph::Graph(const Graph& other) : numVertices(other.numVertices), indexThreshold(other.indexThreshold) {
+    adjacencyList = new VertexList*[numVertices];
+    for (int i = 0; i < numVertices; ++i) {
+        adjacencyList[i] = other.adjacencyList[i];
+        if (adjacencyList[i])
+            adjacencyList[i]->refs++;
+    }
+}
+
+// Move constructor: take the lists and leave 'other' with no vertices.
+Graph::Graph(Graph&& other) noexcept
+    : adjacencyList(other.adjacencyList), numVertices(other.numVertices), indexThreshold(other.indexThreshold) {
+    other.adjacencyList = 0;
+    other.numVertices = 0;
+}
+
+// mutableList: the vertex's list, owned by this graph alone. A list shared
+// with another graph is deep-copied first (and reindexed if it needs one).
+Graph::VertexList& Graph::mutableList(int vertex) {
+    VertexList* list = adjacencyList[vertex];
+    if (!list) {
+        list = new VertexList;
+        adjacencyList[vertex] = list;
+    } else if (list->refs.load() > 1) {
+        VertexList* copy = new VertexList;
+        deepCopyEdgeList(*list, *copy);
+        if (indexThreshold > 0 && copy->degree > indexThreshold)
+            buildIndex(*copy);
+        releaseList(list);
+        adjacencyList[vertex] = list = copy;
+    }
+    return *list;
 }
 
 // Local swap function (using fully-qualified Edge type).
@@ -96,7 +287,10 @@ void swap(Graph& a, Graph& b) {
     int tempNum = a.numVertices;
     a.numVertices = b.numVertices;
     b.numVertices = tempNum;
-    Graph::Edge** tempList = a.adjacencyList;
+    int tempThreshold = a.indexThreshold;
+    a.indexThreshold = b.indexThreshold;
+    b.indexThreshold = tempThreshold;
+    Graph::VertexList** tempList = a.adjacencyList;
     a.adjacencyList = b.adjacencyList;
     b.adjacencyList = tempList;
 }
@@ -107,32 +301,210 @@ Graph& Graph::operator=(Graph other) {
     return *this;
 }
 
+// buildIndex: hash every slot of the list once.
+void Graph::buildIndex(VertexList& list) {
+    list.index = new NeighborIndex(list.degree);
+    for (Edge** slot = &list.head; *slot; slot = &(*slot)->next)
+        list.index->insert((*slot)->destination, slot);
+}
+
+// appendEdge: link the edge at the tail, indexing it if the list is indexed
+// (or has just grown past the threshold).
+void Graph::appendEdge(VertexList& list, Edge* edge) {
+    Edge** slot = list.tail;
+    *slot = edge;
+    list.tail = &edge->next;
+    list.degree++;
+    if (list.index)
+        list.index->insert(edge->destination, slot);
+    else if (indexThreshold > 0 && list.degree > indexThreshold)
+        buildIndex(list);
+}
+
+// unlinkEdge: remove *slot from the list. The edge after it now lives in
+// 'slot', so its index entry (if it is a first occurrence) moves with it.
+void Graph::unlinkEdge(VertexList& list, Edge** slot) {
+    Edge* victim = *slot;
+    *slot = victim->next;
+    if (list.tail == &victim->next)
+        list.tail = slot;
+    list.degree--;
+    if (list.index) {
+        NeighborIndex& index = *list.index;
+        if (victim->next) {
+            int b = index.find(victim->next->destination);
+            if (index.slots[b] == &victim->next)
+                index.slots[b] = slot;
+        }
+        int b = index.find(victim->destination);
+        if (--index.counts[b] == 0) {
+            index.erase(b);
+        } else {
+            // A parallel edge follows; it becomes the indexed first occurrence.
+            Edge** s = slot;
+            while ((*s)->destination != victim->destination)
+                s = &(*s)->next;
+            index.slots[b] = s;
+        }
+        if (list.degree <= indexThreshold / 2) {
+            delete list.index;
+            list.index = 0;
+        }
+    }
+    victim->next = 0;
+    delete victim;
+}
+
+// findSlot: slot holding the first edge to 'to' in an owned list, or null.
+Graph::Edge** Graph::findSlot(VertexList& list, int to) {
+    if (list.index) {
+        int b = list.index->find(to);
+        return b < 0 ? 0 : list.index->slots[b];
+    }
+    for (Edge** slot = &list.head; *slot; slot = &(*slot)->next)
+        if ((*slot)->destination == to)
+            return slot;
+    return 0;
+}
+
+// findEdge: first edge from -> to, or null.
+Graph::Edge* Graph::findEdge(int from, int to) const {
+    const VertexList* list = adjacencyList[from];
+    if (!list)
+        return 0;
+    if (list->index) {
+        int b = list->index->find(to);
+        return b < 0 ? 0 : *list->index->slots[b];
+    }
+    for (Edge* curr = list->head; curr != 0; curr = curr->next)
+        if (curr->destination == to)
+            return curr;
+    return 0;
+}
+
 // addEdge: Appends a new undirected edge by adding at the tail.
 void Graph::addEdge(int source, int dest, int weight) {
     if (source < 0 || source >= numVertices || dest < 0 || dest >= numVertices)
         throw "Vertex index out of range";
-    
+
     // Append new edge from source to dest.
-    Edge* newEdge = new Edge(dest, weight);
-    if (!adjacencyList[source])
-        adjacencyList[source] = newEdge;
-    else {
-        Edge* curr = adjacencyList[source];
-        while (curr->next)
-            curr = curr->next;
-        curr->next = newEdge;
-    }
-    
+    appendEdge(mutableList(source), new Edge(dest, weight));
+
     // For undirected graph, add the reverse edge.
-    Edge* reverseEdge = new Edge(source, weight);
-    if (!adjacencyList[dest])
-        adjacencyList[dest] = reverseEdge;
-    else {
-        Edge* curr = adjacencyList[dest];
-        while (curr->next)
-            curr = curr->next;
-        curr->next = reverseEdge;
+    appendEdge(mutableList(dest), new Edge(source, weight));
+}
+
+// addEdges: sort the batch's directed entries by source, then append each
+// vertex's run to its list in one pass (vertices are processed in parallel).
+void Graph::addEdges(const EdgeTriple* edges, long long count, bool dedup, int threads) {
+    if (count < 0 || count > 2147483647LL)
+        throw "Invalid batch size";
+    for (long long i = 0; i < count; i++)
+        if (edges[i].source < 0 || edges[i].source >= numVertices || edges[i].dest < 0 || edges[i].dest >= numVertices)
+            throw "Vertex index out of range";
+    if (count == 0)
+        return;
+    // Key = (source << 32) | entry, where entry 2i is edge i forwards and 2i + 1 backwards.
+    // A self-loop gets only the forward entry; it expands to two list nodes like addEdge.
+    unsigned long long* keys = new unsigned long long[2 * count];
+    long long numKeys = 0;
+    for (long long i = 0; i < count; i++) {
+        keys[numKeys++] = (static_cast<unsigned long long>(edges[i].source) << 32) | static_cast<unsigned long long>(2 * i);
+        if (edges[i].source != edges[i].dest)
+            keys[numKeys++] = (static_cast<unsigned long long>(edges[i].dest) << 32) | static_cast<unsigned long long>(2 * i + 1);
+    }
+    Parallel::sort(keys, numKeys, threads);
+    // Start index of each source's run of keys.
+    long long* runs = new long long[numKeys + 1];
+    long long numRuns = 0;
+    for (long long k = 0; k < numKeys; k++)
+        if (k == 0 || (keys[k] >> 32) != (keys[k - 1] >> 32))
+            runs[numRuns++] = k;
+    runs[numRuns] = numKeys;
+    int workers = Parallel::resolve(threads);
+    // Per-thread dedup scratch, grown on demand and sized by the largest run
+    // or neighbour list a thread meets, never by the vertex count.
+    unsigned long long** pending = new unsigned long long*[workers]();
+    long long* pendingCapacity = new long long[workers]();
+    int** present = new int*[workers]();
+    long long* presentCapacity = new long long[workers]();
+    Parallel::forDynamic(0, numRuns, 64, workers, [&](int t, long long lo, long long hi) {
+        for (long long r = lo; r < hi; r++) {
+            int u = static_cast<int>(keys[runs[r]] >> 32);
+            VertexList& list = mutableList(u);
+            long long begin = runs[r];
+            long long end = runs[r + 1];
+            auto target = [&](long long entry) {
+                const EdgeTriple& e = edges[entry / 2];
+                return entry % 2 == 0 ? e.dest : e.source;
+            };
+            auto append = [&](long long entry) {
+                int v = target(entry);
+                int w = edges[entry / 2].weight;
+                appendEdge(list, new Edge(v, w));
+                if (u == v)
+                    appendEdge(list, new Edge(v, w));
+            };
+            if (!dedup) {
+                for (long long k = begin; k < end; k++)
+                    append(static_cast<long long>(keys[k] & 0xFFFFFFFFULL));
+                continue;
+            }
+            // Sort the run by (target, entry): the first of each target group
+            // is its earliest occurrence in the batch.
+            long long size = end - begin;
+            if (size > pendingCapacity[t]) {
+                delete[] pending[t];
+                pendingCapacity[t] = 2 * size;
+                pending[t] = new unsigned long long[pendingCapacity[t]];
+            }
+            unsigned long long* run = pending[t];
+            for (long long k = begin; k < end; k++) {
+                long long entry = static_cast<long long>(keys[k] & 0xFFFFFFFFULL);
+                run[k - begin] = (static_cast<unsigned long long>(target(entry)) << 32) | static_cast<unsigned long long>(entry);
+            }
+            std::sort(run, run + size);
+            // Indexed lists answer "already adjacent?" directly; others are
+            // copied once into a sorted array and searched.
+            int known = 0;
+            if (!list.index) {
+                if (list.degree > presentCapacity[t]) {
+                    delete[] present[t];
+                    presentCapacity[t] = 2 * static_cast<long long>(list.degree);
+                    present[t] = new int[presentCapacity[t]];
+                }
+                for (Edge* e = list.head; e != 0; e = e->next)
+                    present[t][known++] = e->destination;
+                std::sort(present[t], present[t] + known);
+            }
+            long long kept = 0;
+            int previous = -1;
+            for (long long i = 0; i < size; i++) {
+                int v = static_cast<int>(run[i] >> 32);
+                if (v == previous)
+                    continue;
+                previous = v;
+                bool seen = list.index ? list.index->find(v) >= 0
+                                       : std::binary_search(present[t], present[t] + known, v);
+                if (!seen)
+                    run[kept++] = run[i] & 0xFFFFFFFFULL;
+            }
+            // Survivors go in batch order, like the addEdge calls they replace.
+            std::sort(run, run + kept);
+            for (long long i = 0; i < kept; i++)
+                append(static_cast<long long>(run[i]));
+        }
+    });
+    for (int t = 0; t < workers; t++) {
+        delete[] pending[t];
+        delete[] present[t];
     }
+    delete[] pending;
+    delete[] pendingCapacity;
+    delete[] present;
+    delete[] presentCapacity;
+    delete[] runs;
+    delete[] keys;
 }
 
 // removeEdge: Remove the edge from source->dest and dest->source.
@@ -140,38 +512,95 @@ void Graph::addEdge(int source, int dest, int weight) {
 void Graph::removeEdge(int source, int dest) {
     if (source < 0 || source >= numVertices || dest < 0 || dest >= numVertices)
         throw "Vertex index out of range";
-    
+
     bool removedForward = false;
     bool removedReverse = false;
-    
-    // Lambda to remove a single directed edge.
+
+    // Lambda to remove a single directed edge (index lookup or list scan).
+    // A shared list is only unshared once the edge is known to be there.
     auto removeSingle = [this](int from, int to) -> bool {
-        Edge** currPtr = &adjacencyList[from];
-        while (*currPtr) {
-            if ((*currPtr)->destination == to) {
-                Edge* temp = *currPtr;
-                *currPtr = (*currPtr)->next;
-                temp->next = 0;
-                delete temp;
-                return true;
-            }
-            currPtr = &((*currPtr)->next);
-        }
-        return false;
+        VertexList* shared = adjacencyList[from];
+        if (!shared || (shared->refs.load() > 1 && !findEdge(from, to)))
+            return false;
+        VertexList& list = mutableList(from);
+        Edge** slot = findSlot(list, to);
+        if (!slot)
+            return false;
+        unlinkEdge(list, slot);
+        return true;
     };
-    
+
     removedForward = removeSingle(source, dest);
     removedReverse = removeSingle(dest, source);
-    
+
     if (!removedForward && !removedReverse)
         throw "Edge does not exist";
 }
 
+// hasEdge: Whether source and dest are adjacent.
+bool Graph::hasEdge(int source, int dest) const {
+    if (source < 0 || source >= numVertices || dest < 0 || dest >= numVertices)
+        throw "Vertex index out of range";
+    return findEdge(source, dest) != 0;
+}
+
+// getWeight: Weight of the edge from source to dest.
+int Graph::getWeight(int source, int dest) const {
+    if (source < 0 || source >= numVertices || dest < 0 || dest >= numVertices)
+        throw "Vertex index out of range";
+    Edge* e = findEdge(source, dest);
+    if (!e)
+        throw "Edge does not exist";
+    return e->weight;
+}
+
+// updateWeight: Change the weight in both directions.
+void Graph::updateWeight(int source, int dest, int weight) {
+    if (source < 0 || source >= numVertices || dest < 0 || dest >= numVertices)
+        throw "Vertex index out of range";
+    bool forward = findEdge(source, dest) != 0;
+    bool reverse = findEdge(dest, source) != 0;
+    if (!forward && !reverse)
+        throw "Edge does not exist";
+    // Unshare before writing, then look the edge up in the private copy.
+    if (forward) {
+        mutableList(source);
+        findEdge(source, dest)->weight = weight;
+    }
+    if (reverse) {
+        mutableList(dest);
+        findEdge(dest, source)->weight = weight;
+    }
+}
+
+// setIndexThreshold: (re)build or drop indexes to match the new threshold.
+void Graph::setIndexThreshold(int threshold) {
+    indexThreshold = threshold > 0 ? threshold : 0;
+    for (int i = 0; i < numVertices; ++i) {
+        if (!adjacencyList[i])
+            continue;
+        bool wanted = indexThreshold > 0 && adjacencyList[i]->degree > indexThreshold;
+        if ((adjacencyList[i]->index != 0) == wanted)
+            continue;
+        VertexList& list = mutableList(i); // Builds the index if it unshares.
+        if (list.index && !wanted) {
+            delete list.index;
+            list.index = 0;
+        } else if (!list.index && wanted) {
+            buildIndex(list);
+        }
+    }
+}
+
+int Graph::getIndexThreshold() const {
+    return indexThreshold;
+}
+
 // print_graph: Prints the adjacency list of each vertex.
 void Graph::print_graph() const {
     for (int i = 0; i < numVertices; ++i) {
         std::cout << "Vertex " << i << " -> ";
-        for (Edge* curr = adjacencyList[i]; curr != 0; curr = curr->next)
+        for (Edge* curr = getAdjList(i); curr != 0; curr = curr->next)
             std::cout << "(" << curr->destination << ", weight: " << curr->weight << ") ";
         std::cout << "\n";
     }
@@ -182,11 +611,18 @@ int Graph::getNumVertices() const {
     return numVertices;
 }
 
+// getDegree: Returns the number of adjacency entries of a vertex.
+int Graph::getDegree(int vertex) const {
+    if (vertex < 0 || vertex >= numVertices)
+        throw "Vertex index out of range";
+    return adjacencyList[vertex] ? adjacencyList[vertex]->degree : 0;
+}
+
 // getAdjList: Returns the adjacency list for a vertex.
 Graph::Edge* Graph::getAdjList(int vertex) const {
     if (vertex < 0 || vertex >= numVertices)
         throw "Vertex index out of range";
-    return adjacencyList[vertex];
+    return adjacencyList[vertex] ? adjacencyList[vertex]->head : 0;
 }
 
 } // namespace graph
@@ -0,0 +1,227 @@
+// Instrumentation.cpp
+// Optional per-call counters for the graph routines. Compiled out unless
+// GRAPH_INSTRUMENT is defined (make ... INSTRUMENT=1); the API below stays
+// available either way so callers build in both configurations.
+#ifndef INSTRUMENTATION_CPP
+#define INSTRUMENTATION_CPP
+
+#ifdef GRAPH_INSTRUMENT
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace graph {
+
+// Counters collected for one top-level routine call.
+struct CallStats {
+    static const int MaxLevels = 1024;
+
+    const char* routine;   // Null when nothing has been recorded.
+    bool hardwareCounters; // False when perf_event_open is unavailable.
+    long long cycles;
+    long long instructions;
+    long long llcMisses;
+    long long branchMisses;
+    long long edgesScanned;
+    long long heapPushes;
+    long long heapPops;
+    long long decreaseKeys;
+    long long unionFindOps;
+    int levels;                         // BFS levels seen (may exceed MaxLevels).
+    long long frontierSizes[MaxLevels]; // Vertices per BFS level, first MaxLevels only.
+
+    CallStats() { clear(0); }
+    void clear(const char* name) {
+        routine = name;
+        hardwareCounters = false;
+        cycles = instructions = llcMisses = branchMisses = 0;
+        edgesScanned = heapPushes = heapPops = decreaseKeys = unionFindOps = 0;
+        levels = 0;
+        levelRemaining = nextLevel = 0;
+    }
+    // BFS queue hooks: a level ends once all vertices pushed before it are popped.
+    void frontierPush() { nextLevel++; }
+    void frontierPop() {
+        if (levelRemaining == 0) {
+            if (levels < MaxLevels)
+                frontierSizes[levels] = nextLevel;
+            levels++;
+            levelRemaining = nextLevel;
+            nextLevel = 0;
+        }
+        levelRemaining--;
+    }
+
+private:
+    long long levelRemaining;
+    long long nextLevel;
+};
+
+class Instrumentation {
+public:
+    // True when the library was built with GRAPH_INSTRUMENT.
+    static bool enabled();
+    // Stats of the most recent instrumented call on this thread.
+    static const CallStats& lastCall();
+    // Forgets the last call so a later uninstrumented routine reports nothing.
+    static void clearLastCall();
+
+#ifdef GRAPH_INSTRUMENT
+    // Stats being filled by the call in progress on this thread.
+    static CallStats& current();
+
+    // Opens the counters for the outermost routine and publishes them on exit;
+    // nested routines add to the enclosing call.
+    class Scope {
+    public:
+        explicit Scope(const char* routine);
+        ~Scope();
+    private:
+        bool outermost;
+    };
+
+private:
+    struct Counters {
+        int fds[4];
+        bool opened;
+        Counters() : opened(false) {
+            for (int i = 0; i < 4; i++)
+                fds[i] = -1;
+        }
+        ~Counters() {
+            for (int i = 3; i >= 0; i--)
+                if (fds[i] >= 0)
+                    close(fds[i]);
+        }
+    };
+    static Counters& counters();
+    static int& depth();
+    static CallStats& last();
+#endif
+};
+
+#ifdef GRAPH_INSTRUMENT
+
+bool Instrumentation::enabled() {
+    return true;
+}
+
+CallStats& Instrumentation::current() {
+    static thread_local CallStats stats;
+    return stats;
+}
+
+CallStats& Instrumentation::last() {
+    static thread_local CallStats stats;
+    return stats;
+}
+
+const CallStats& Instrumentation::lastCall() {
+    return last();
+}
+
+void Instrumentation::clearLastCall() {
+    last().clear(0);
+}
+
+int& Instrumentation::depth() {
+    static thread_local int d = 0;
+    return d;
+}
+
+// Lazily opens one perf event group per thread: cycles (leader), instructions,
+// last-level cache misses, and branch misses, user space only.
+Instrumentation::Counters& Instrumentation::counters() {
+    static thread_local Counters c;
+    if (!c.opened) {
+        c.opened = true;
+        const unsigned long long configs[4] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int i = 0; i < 4; i++) {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = i == 0 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            c.fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : c.fds[0], 0));
+            if (c.fds[i] < 0) {
+                for (int j = i - 1; j >= 0; j--) {
+                    close(c.fds[j]);
+                    c.fds[j] = -1;
+                }
+                break;
+            }
+        }
+    }
+    return c;
+}
+
+Instrumentation::Scope::Scope(const char* routine) : outermost(depth()++ == 0) {
+    if (!outermost)
+        return;
+    current().clear(routine);
+    Counters& c = counters();
+    if (c.fds[0] >= 0) {
+        ioctl(c.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(c.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+Instrumentation::Scope::~Scope() {
+    depth()--;
+    if (!outermost)
+        return;
+    CallStats& stats = current();
+    Counters& c = counters();
+    if (c.fds[0] >= 0) {
+        ioctl(c.fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        unsigned long long values[5]; // Event count followed by one value per event.
+        if (read(c.fds[0], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)) && values[0] == 4) {
+            stats.hardwareCounters = true;
+            stats.cycles = static_cast<long long>(values[1]);
+            stats.instructions = static_cast<long long>(values[2]);
+            stats.llcMisses = static_cast<long long>(values[3]);
+            stats.branchMisses = static_cast<long long>(values[4]);
+        }
+    }
+    last() = stats;
+}
+
+#define GRAPH_INSTRUMENT_SCOPE(name) graph::Instrumentation::Scope graphInstrumentScope_(name)
+#define GRAPH_COUNT(field, amount) (graph::Instrumentation::current().field += (amount))
+#define GRAPH_FRONTIER_PUSH() graph::Instrumentation::current().frontierPush()
+#define GRAPH_FRONTIER_POP() graph::Instrumentation::current().frontierPop()
+
+#else // !GRAPH_INSTRUMENT
+
+bool Instrumentation::enabled() {
+    return false;
+}
+
+const CallStats& Instrumentation::lastCall() {
+    static const CallStats empty;
+    return empty;
+}
+
+void Instrumentation::clearLastCall() {
+}
+
+#define GRAPH_INSTRUMENT_SCOPE(name) ((void)0)
+#define GRAPH_COUNT(field, amount) ((void)0)
+#define GRAPH_FRONTIER_PUSH() ((void)0)
+#define GRAPH_FRONTIER_POP() ((void)0)
+
+#endif // GRAPH_INSTRUMENT
+
+} // namespace graph
+
+#endif // INSTRUMENTATION_CPP
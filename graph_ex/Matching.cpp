@@ -0,0 +1,275 @@
+// Matching.cpp
+#ifndef MATCHING_CPP
+#define MATCHING_CPP
+
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include "SpMV.cpp"
+#include <atomic>
+
+namespace graph {
+
+// Maximum-cardinality matching in bipartite graphs.
+class Matching {
+public:
+    // Hopcroft-Karp. left[v] gives the side of v; when null the sides come
+    // from bipartition(). mate[v] receives v's partner or -1. Returns the
+    // number of matched pairs. Throws if an edge joins two vertices of the
+    // same side.
+    static int hopcroftKarp(const CSRGraph& g, int* mate, const bool* left = 0, int threads = 0);
+    static int hopcroftKarp(const Graph& g, int* mate, const bool* left = 0, int threads = 0);
+    // Two-colours every component by BFS (lowest vertex on the left);
+    // returns false if some component has an odd cycle.
+    static bool bipartition(const CSRGraph& g, bool* left);
+
+private:
+    // Layers for one phase: layer[v] for left vertices (their BFS depth) and
+    // right vertices (the depth of the left vertex that reached them).
+    static bool layer(const CSRGraph& g, const bool* left, const int* mate, int* layer,
+                      unsigned char* frontierValues, unsigned char* reached, bool* visited,
+                      int* frontier, int* next, SpMV::Workspace& ws, int threads);
+};
+
+bool Matching::bipartition(const CSRGraph& g, bool* left) {
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    int* colour = new int[n];
+    int* queue = new int[n];
+    for (int v = 0; v < n; v++)
+        colour[v] = -1;
+    bool ok = true;
+    for (int root = 0; root < n && ok; root++) {
+        if (colour[root] >= 0)
+            continue;
+        colour[root] = 0;
+        queue[0] = root;
+        int tail = 1;
+        for (int head = 0; head < tail && ok; head++) {
+            int u = queue[head];
+            for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                int v = targets[e];
+                if (colour[v] < 0) {
+                    colour[v] = 1 - colour[u];
+                    queue[tail++] = v;
+                } else if (colour[v] == colour[u]) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+    for (int v = 0; v < n; v++)
+        left[v] = colour[v] == 0;
+    delete[] colour;
+    delete[] queue;
+    return ok;
+}
+
+// layer: the alternating BFS. Each step is one masked Boolean SpMV from the
+// current left frontier to the unvisited right vertices (left vertices are
+// pre-marked visited so the mask never admits them); matched right vertices
+// hand their mates to the next frontier. Stops after the first layer that
+// reaches a free right vertex; returns whether one was reached.
+bool Matching::layer(const CSRGraph& g, const bool* left, const int* mate, int* layer,
+                     unsigned char* frontierValues, unsigned char* reached, bool* visited,
+                     int* frontier, int* next, SpMV::Workspace& ws, int threads) {
+    int n = g.getNumVertices();
+    long long frontierSize = 0;
+    for (int v = 0; v < n; v++) {
+        visited[v] = left[v];
+        reached[v] = 0;
+        layer[v] = -1;
+        if (left[v] && mate[v] < 0) {
+            layer[v] = 0;
+            frontierValues[v] = 1;
+            frontier[frontierSize++] = v;
+        }
+    }
+    SpMV::Mask unvisited = {visited, true};
+    bool found = false;
+    for (int depth = 0; frontierSize > 0 && !found; depth++) {
+        long long numReached = SpMV::multiply<BooleanSemiring>(g, frontierValues, frontier, frontierSize,
+                                                               reached, unvisited, next, ws, threads);
+        for (long long i = 0; i < frontierSize; i++)
+            frontierValues[frontier[i]] = 0;
+        long long nextSize = 0;
+        for (long long i = 0; i < numReached; i++) {
+            int r = next[i];
+            visited[r] = true;
+            layer[r] = depth;
+            if (mate[r] < 0) {
+                found = true;
+            } else {
+                layer[mate[r]] = depth + 1;
+                frontier[nextSize++] = mate[r];
+            }
+        }
+        if (found)
+            nextSize = 0;
+        for (long long i = 0; i < nextSize; i++)
+            frontierValues[frontier[i]] = 1;
+        frontierSize = nextSize;
+    }
+    for (long long i = 0; i < frontierSize; i++)
+        frontierValues[frontier[i]] = 0;
+    return found;
+}
+
+// hopcroftKarp: a greedy matching to start, then phases. Each phase layers
+// the graph, then searches for vertex-disjoint shortest augmenting paths
+// from the free left vertices in parallel. A search claims a right vertex
+// with an atomic exchange before following its mate, so every right vertex
+// (and with it, its mate) belongs to at most one search per phase and the
+// mates along a path are rewritten by its owner alone. The searches are
+// iterative, with a per-vertex next-arc cursor; dead ends are not revisited.
+int Matching::hopcroftKarp(const CSRGraph& g, int* mate, const bool* left, int threads) {
+    GRAPH_INSTRUMENT_SCOPE("hopcroft_karp");
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    bool* side = new bool[n];
+    if (left) {
+        std::copy(left, left + n, side);
+    } else if (!bipartition(g, side)) {
+        delete[] side;
+        throw "Graph is not bipartite";
+    }
+    for (int u = 0; u < n; u++)
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++)
+            if (side[u] == side[targets[e]]) {
+                delete[] side;
+                throw "Edge joins two vertices on the same side";
+            }
+    threads = Parallel::resolve(threads);
+    for (int v = 0; v < n; v++)
+        mate[v] = -1;
+    int matched = 0;
+    for (int u = 0; u < n; u++) {
+        if (!side[u])
+            continue;
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++)
+            if (mate[targets[e]] < 0) {
+                mate[u] = targets[e];
+                mate[targets[e]] = u;
+                matched++;
+                break;
+            }
+    }
+    int* layers = new int[n];
+    unsigned char* frontierValues = new unsigned char[n]();
+    unsigned char* reached = new unsigned char[n];
+    bool* visited = new bool[n];
+    int* frontier = new int[n];
+    int* next = new int[n];
+    int* freeLeft = new int[n];
+    long long* cursor = new long long[n];
+    std::atomic<unsigned char>* claimed = new std::atomic<unsigned char>[n];
+    // Paths are only as long as the layering is deep, so each thread's
+    // stacks start small and grow on demand.
+    int** stack = new int*[threads];
+    int** via = new int*[threads];
+    int* capacity = new int[threads];
+    for (int t = 0; t < threads; t++) {
+        capacity[t] = 16;
+        stack[t] = new int[capacity[t]];
+        via[t] = new int[capacity[t]];
+    }
+    SpMV::Workspace ws(n);
+    while (layer(g, side, mate, layers, frontierValues, reached, visited, frontier, next, ws, threads)) {
+        int numFree = 0;
+        for (int v = 0; v < n; v++)
+            if (side[v] && mate[v] < 0)
+                freeLeft[numFree++] = v;
+        auto phase = [&](int workers) {
+            for (int v = 0; v < n; v++) {
+                cursor[v] = offsets[v];
+                claimed[v].store(0, std::memory_order_relaxed);
+            }
+            std::atomic<int> augmented(0);
+            Parallel::forDynamic(0, numFree, 64, workers, [&](int t, long long lo, long long hi) {
+                int* path = stack[t]; // Left vertices of the current path.
+                int* used = via[t];   // Right vertex taken from each of them.
+                int local = 0;
+                for (long long i = lo; i < hi; i++) {
+                    int top = 0;
+                    path[0] = freeLeft[i];
+                    while (top >= 0) {
+                        int u = path[top];
+                        bool advanced = false;
+                        while (cursor[u] < offsets[u + 1]) {
+                            int r = targets[cursor[u]++];
+                            if (layers[r] != layers[u] || claimed[r].exchange(1, std::memory_order_acq_rel))
+                                continue;
+                            used[top] = r;
+                            if (mate[r] < 0) {
+                                for (int k = top; k >= 0; k--) {
+                                    mate[path[k]] = used[k];
+                                    mate[used[k]] = path[k];
+                                }
+                                local++;
+                                top = -1;
+                            } else {
+                                if (top + 1 == capacity[t]) {
+                                    int* biggerPath = new int[capacity[t] * 2];
+                                    int* biggerUsed = new int[capacity[t] * 2];
+                                    std::copy(path, path + top + 1, biggerPath);
+                                    std::copy(used, used + top + 1, biggerUsed);
+                                    delete[] path;
+                                    delete[] used;
+                                    path = stack[t] = biggerPath;
+                                    used = via[t] = biggerUsed;
+                                    capacity[t] *= 2;
+                                }
+                                path[++top] = mate[r];
+                            }
+                            advanced = true;
+                            break;
+                        }
+                        if (!advanced)
+                            top--;
+                    }
+                }
+                augmented.fetch_add(local, std::memory_order_relaxed);
+            });
+            GRAPH_COUNT(edgesScanned, g.getNumEntries());
+            return augmented.load();
+        };
+        // Claims on right vertices outlive a backtracking search, so parallel
+        // searches can block one another and a phase may augment nothing even
+        // though an augmenting path exists. The layering would then repeat
+        // unchanged; a sequential rerun of the phase always finds at least one
+        // shortest augmenting path, so every phase makes progress.
+        int found = phase(threads);
+        if (found == 0 && threads > 1)
+            found = phase(1);
+        matched += found;
+    }
+    for (int t = 0; t < threads; t++) {
+        delete[] stack[t];
+        delete[] via[t];
+    }
+    delete[] stack;
+    delete[] via;
+    delete[] capacity;
+    delete[] side;
+    delete[] layers;
+    delete[] frontierValues;
+    delete[] reached;
+    delete[] visited;
+    delete[] frontier;
+    delete[] next;
+    delete[] freeLeft;
+    delete[] cursor;
+    delete[] claimed;
+    return matched;
+}
+
+int Matching::hopcroftKarp(const Graph& g, int* mate, const bool* left, int threads) {
+    return hopcroftKarp(CSRGraph::fromGraph(g, threads), mate, left, threads);
+}
+
+} // namespace graph
+
+#endif // MATCHING_CPP
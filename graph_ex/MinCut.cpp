@@ -0,0 +1,488 @@
+// MinCut.cpp
+#ifndef MINCUT_CPP
+#define MINCUT_CPP
+
+#include "Algorithms.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <algorithm>
+#include <cmath>
+
+namespace graph {
+
+// Global minimum cut of a weighted undirected graph: the lightest set of
+// edges whose removal disconnects it. Weights must be non-negative; a
+// disconnected graph has a cut of 0. side (optional, getNumVertices()
+// entries) receives one shore of the cut; both shores are non-empty.
+class MinCut {
+public:
+    // Exact Stoer-Wagner: n - 1 maximum-adjacency phases, each over a lazy
+    // max-heap, O(V (V + E) log E) in all.
+    static long long stoerWagner(const Graph& g, bool* side = 0);
+    // Karger-Stein recursive contraction, repeated 'trials' times in parallel
+    // (0 = kargerSteinTrials(n, 0.01)). Each run finds a given minimum cut
+    // with probability Omega(1 / log n); the result is never below the
+    // minimum and depends only on the seed, not on the threads.
+    static long long kargerStein(const Graph& g, bool* side = 0, int trials = 0, unsigned long long seed = 1,
+                                 int threads = 0);
+    // Runs that miss a minimum cut with probability at most 'failure',
+    // taking the per-run success probability as 1 / log2 n.
+    static int kargerSteinTrials(int vertices, double failure);
+
+    // Below this many vertices, a Karger-Stein branch is solved by Stoer-Wagner.
+    static const int BaseVertices = 32;
+
+private:
+    struct WeightedEdge {
+        int u, v;
+        long long weight;
+    };
+    // Per-trial state: the current best cut and the chain of vertex maps
+    // from the input graph down to the current branch.
+    struct Trial {
+        unsigned long long state;
+        long long best;
+        long long scanned; // Edges read by the contractions, for edgesScanned.
+        bool* side;       // Over the input vertices.
+        int* path[128];   // path[d][x] = vertex of level d + 1 holding vertex x of level d.
+        int* levelSize;   // Vertices at each level.
+        bool* leafSide;   // Scratch for base cases.
+        long long* matrix; // BaseVertices^2 scratch for base cases.
+        int* owner;       // BaseVertices scratch for base cases.
+    };
+    // Edges with u < v and positive weight; throws on a negative weight.
+    static WeightedEdge* collectEdges(const Graph& g, long long& count);
+    // Stoer-Wagner over an edge list on 'vertices' vertices.
+    static long long stoerWagnerEdges(int vertices, const WeightedEdge* edges, long long count, bool* side);
+    // O(V^3) Stoer-Wagner over a weight matrix, for the small, dense
+    // Karger-Stein base cases; matrix and owner are scratch.
+    static long long stoerWagnerDense(int vertices, const WeightedEdge* edges, long long count, bool* side,
+                                      long long* matrix, int* owner);
+    // Contracts random edges (weighted by an exponential race) until
+    // 'target' vertices remain; returns the merged edge list.
+    static WeightedEdge* contract(int vertices, const WeightedEdge* edges, long long count, int target, int* map,
+                                  long long& merged, unsigned long long& state);
+    static void recurse(int vertices, const WeightedEdge* edges, long long count, int depth, Trial& trial);
+    static unsigned long long next(unsigned long long& state);
+};
+
+// next: SplitMix64 step.
+unsigned long long MinCut::next(unsigned long long& state) {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+MinCut::WeightedEdge* MinCut::collectEdges(const Graph& g, long long& count) {
+    int n = g.getNumVertices();
+    count = 0;
+    for (int u = 0; u < n; u++)
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next) {
+            if (e->weight < 0)
+                throw "Negative edge weight";
+            if (u < e->destination && e->weight > 0)
+                count++;
+        }
+    WeightedEdge* edges = new WeightedEdge[count + 1];
+    count = 0;
+    for (int u = 0; u < n; u++)
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next)
+            if (u < e->destination && e->weight > 0) {
+                WeightedEdge edge = {u, e->destination, e->weight};
+                edges[count++] = edge;
+            }
+    return edges;
+}
+
+// stoerWagnerEdges: supervertices are linked lists of input vertices with a
+// label per vertex, and every phase walks the input adjacency through the
+// labels, so a merge only relabels the absorbed members. A phase grows the
+// set A by the supervertex most tightly connected to it (keys only rise, so
+// stale heap entries are those whose key has moved on); the last two added,
+// s and t, are merged, and the weight joining t to the rest is the lightest
+// cut separating s from t.
+long long MinCut::stoerWagnerEdges(int vertices, const WeightedEdge* edges, long long count, bool* side) {
+    int n = vertices;
+    long long* offsets = new long long[n + 1]();
+    int* targets = new int[2 * count + 1];
+    long long* weights = new long long[2 * count + 1];
+    for (long long i = 0; i < count; i++) {
+        offsets[edges[i].u + 1]++;
+        offsets[edges[i].v + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        offsets[v + 1] += offsets[v];
+    long long* cursor = new long long[n];
+    std::copy(offsets, offsets + n, cursor);
+    for (long long i = 0; i < count; i++) {
+        long long p = cursor[edges[i].u]++;
+        targets[p] = edges[i].v;
+        weights[p] = edges[i].weight;
+        p = cursor[edges[i].v]++;
+        targets[p] = edges[i].u;
+        weights[p] = edges[i].weight;
+    }
+    int* label = new int[n];
+    int* nextMember = new int[n];
+    int* lastMember = new int[n];
+    int* active = new int[n];
+    int* added = new int[n];
+    long long* key = new long long[n];
+    long long heapCapacity = n + 2 * count;
+    long long* heapKey = new long long[heapCapacity];
+    int* heapVertex = new int[heapCapacity];
+    for (int v = 0; v < n; v++) {
+        label[v] = v;
+        nextMember[v] = -1;
+        lastMember[v] = v;
+        active[v] = v;
+        added[v] = -1;
+    }
+    long long heapSize = 0;
+    auto push = [&](long long k, int v) {
+        long long i = heapSize++;
+        while (i > 0 && heapKey[(i - 1) / 2] < k) {
+            heapKey[i] = heapKey[(i - 1) / 2];
+            heapVertex[i] = heapVertex[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heapKey[i] = k;
+        heapVertex[i] = v;
+    };
+    auto pop = [&](long long& k, int& v) {
+        k = heapKey[0];
+        v = heapVertex[0];
+        long long lastKey = heapKey[--heapSize];
+        int lastVertex = heapVertex[heapSize];
+        long long i = 0;
+        while (2 * i + 1 < heapSize) {
+            long long c = 2 * i + 1;
+            if (c + 1 < heapSize && heapKey[c + 1] > heapKey[c])
+                c++;
+            if (heapKey[c] <= lastKey)
+                break;
+            heapKey[i] = heapKey[c];
+            heapVertex[i] = heapVertex[c];
+            i = c;
+        }
+        heapKey[i] = lastKey;
+        heapVertex[i] = lastVertex;
+    };
+    long long best = -1;
+    for (int numActive = n, phase = 0; numActive > 1; phase++) {
+        heapSize = 0;
+        for (int i = 0; i < numActive; i++) {
+            key[active[i]] = 0;
+            push(0, active[i]);
+        }
+        int prev = -1, last = -1;
+        for (int numAdded = 0; numAdded < numActive;) {
+            long long k;
+            int x;
+            pop(k, x);
+            if (added[x] == phase || k != key[x])
+                continue;
+            added[x] = phase;
+            numAdded++;
+            prev = last;
+            last = x;
+            for (int y = x; y != -1; y = nextMember[y])
+                for (long long e = offsets[y]; e < offsets[y + 1]; e++) {
+                    int z = label[targets[e]];
+                    if (added[z] != phase) {
+                        key[z] += weights[e];
+                        push(key[z], z);
+                    }
+                }
+        }
+        GRAPH_COUNT(edgesScanned, 2 * count);
+        if (best < 0 || key[last] < best) {
+            best = key[last];
+            if (side)
+                for (int v = 0; v < n; v++)
+                    side[v] = label[v] == last;
+        }
+        // Merge last into prev.
+        for (int y = last; y != -1; y = nextMember[y])
+            label[y] = prev;
+        nextMember[lastMember[prev]] = last;
+        lastMember[prev] = lastMember[last];
+        for (int i = 0; i < numActive; i++)
+            if (active[i] == last) {
+                active[i] = active[--numActive];
+                break;
+            }
+    }
+    delete[] offsets;
+    delete[] targets;
+    delete[] weights;
+    delete[] cursor;
+    delete[] label;
+    delete[] nextMember;
+    delete[] lastMember;
+    delete[] active;
+    delete[] added;
+    delete[] key;
+    delete[] heapKey;
+    delete[] heapVertex;
+    return best;
+}
+
+// stoerWagnerDense: the same phases with a linear scan for the tightest
+// supervertex; merging t into s adds t's row and column to s's.
+long long MinCut::stoerWagnerDense(int vertices, const WeightedEdge* edges, long long count, bool* side,
+                                   long long* matrix, int* owner) {
+    int n = vertices;
+    std::fill(matrix, matrix + n * n, 0LL);
+    for (long long i = 0; i < count; i++) {
+        matrix[edges[i].u * n + edges[i].v] += edges[i].weight;
+        matrix[edges[i].v * n + edges[i].u] += edges[i].weight;
+    }
+    int active[BaseVertices];
+    long long key[BaseVertices];
+    bool added[BaseVertices];
+    for (int v = 0; v < n; v++) {
+        owner[v] = v;
+        active[v] = v;
+    }
+    long long best = -1;
+    for (int numActive = n; numActive > 1; numActive--) {
+        for (int i = 0; i < numActive; i++) {
+            key[active[i]] = 0;
+            added[active[i]] = false;
+        }
+        int prev = -1, last = -1;
+        for (int step = 0; step < numActive; step++) {
+            int x = -1;
+            for (int i = 0; i < numActive; i++)
+                if (!added[active[i]] && (x < 0 || key[active[i]] > key[x]))
+                    x = active[i];
+            added[x] = true;
+            prev = last;
+            last = x;
+            for (int i = 0; i < numActive; i++)
+                key[active[i]] += matrix[x * n + active[i]];
+        }
+        if (best < 0 || key[last] < best) {
+            best = key[last];
+            for (int v = 0; v < n; v++)
+                side[v] = owner[v] == last;
+        }
+        for (int i = 0; i < numActive; i++) {
+            int y = active[i];
+            matrix[prev * n + y] += matrix[last * n + y];
+            matrix[y * n + prev] = matrix[prev * n + y];
+        }
+        matrix[prev * n + prev] = 0;
+        for (int v = 0; v < n; v++)
+            if (owner[v] == last)
+                owner[v] = prev;
+        for (int i = 0; i < numActive; i++)
+            if (active[i] == last) {
+                active[i] = active[numActive - 1];
+                break;
+            }
+    }
+    return best;
+}
+
+long long MinCut::stoerWagner(const Graph& g, bool* side) {
+    int n = g.getNumVertices();
+    if (n < 2)
+        throw "Graph needs at least two vertices";
+    GRAPH_INSTRUMENT_SCOPE("stoer_wagner");
+    long long count;
+    WeightedEdge* edges = collectEdges(g, count);
+    long long best = stoerWagnerEdges(n, edges, count, side);
+    delete[] edges;
+    return best;
+}
+
+// contract: every edge draws an exponential variate with rate equal to its
+// weight, and edges are contracted in increasing order of their draws (as in
+// Kruskal's algorithm), which picks each next edge with probability
+// proportional to its weight, like Karger's random contraction. The
+// survivors are relabelled 0 .. target - 1, and parallel edges merged.
+MinCut::WeightedEdge* MinCut::contract(int vertices, const WeightedEdge* edges, long long count, int target,
+                                       int* map, long long& merged, unsigned long long& state) {
+    struct Draw {
+        double key;
+        long long edge;
+        bool operator<(const Draw& other) const { return key < other.key; }
+    };
+    Draw* draws = new Draw[count + 1];
+    for (long long i = 0; i < count; i++) {
+        double u = ((next(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+        Draw d = {-std::log(u) / static_cast<double>(edges[i].weight), i};
+        draws[i] = d;
+    }
+    std::sort(draws, draws + count);
+    UnionFind uf(vertices);
+    int components = vertices;
+    for (long long i = 0; i < count && components > target; i++) {
+        const WeightedEdge& e = edges[draws[i].edge];
+        if (!uf.isConnected(e.u, e.v)) {
+            uf.unite(e.u, e.v);
+            components--;
+        }
+    }
+    delete[] draws;
+    int* id = new int[vertices];
+    for (int v = 0; v < vertices; v++)
+        id[v] = -1;
+    int numIds = 0;
+    for (int v = 0; v < vertices; v++) {
+        int r = uf.find(v);
+        if (id[r] < 0)
+            id[r] = numIds++;
+        map[v] = id[r];
+    }
+    delete[] id;
+    WeightedEdge* out = new WeightedEdge[count + 1];
+    long long kept = 0;
+    for (long long i = 0; i < count; i++) {
+        int a = map[edges[i].u], b = map[edges[i].v];
+        if (a == b)
+            continue;
+        WeightedEdge e = {std::min(a, b), std::max(a, b), edges[i].weight};
+        out[kept++] = e;
+    }
+    std::sort(out, out + kept, [](const WeightedEdge& x, const WeightedEdge& y) {
+        return x.u != y.u ? x.u < y.u : x.v < y.v;
+    });
+    merged = 0;
+    for (long long i = 0; i < kept; i++) {
+        if (merged > 0 && out[merged - 1].u == out[i].u && out[merged - 1].v == out[i].v)
+            out[merged - 1].weight += out[i].weight;
+        else
+            out[merged++] = out[i];
+    }
+    return out;
+}
+
+// recurse: two independent contractions to 1 + n / sqrt(2) vertices, each
+// searched recursively, so a minimum cut survives a branch with probability
+// at least about 1/2 per level. A better cut at a base case is mapped back to
+// the input vertices through the chain of level maps.
+void MinCut::recurse(int vertices, const WeightedEdge* edges, long long count, int depth, Trial& trial) {
+    if (vertices <= BaseVertices) {
+        long long cut = stoerWagnerDense(vertices, edges, count, trial.leafSide, trial.matrix, trial.owner);
+        if (cut < trial.best) {
+            trial.best = cut;
+            for (int v = 0; v < trial.levelSize[0]; v++) {
+                int x = v;
+                for (int d = 0; d < depth; d++)
+                    x = trial.path[d][x];
+                trial.side[v] = trial.leafSide[x];
+            }
+        }
+        return;
+    }
+    int target = static_cast<int>(std::ceil(1 + vertices / std::sqrt(2.0)));
+    if (target >= vertices)
+        target = vertices - 1;
+    int* map = new int[vertices];
+    trial.path[depth] = map;
+    trial.levelSize[depth + 1] = target;
+    for (int branch = 0; branch < 2; branch++) {
+        long long merged;
+        WeightedEdge* contracted = contract(vertices, edges, count, target, map, merged, trial.state);
+        trial.scanned += count;
+        recurse(target, contracted, merged, depth + 1, trial);
+        delete[] contracted;
+    }
+    delete[] map;
+}
+
+// kargerStein: a disconnected graph is answered directly; otherwise each
+// trial runs one recursion with its own random stream, in parallel, and the
+// lightest cut wins (the earliest trial on ties).
+long long MinCut::kargerStein(const Graph& g, bool* side, int trials, unsigned long long seed, int threads) {
+    int n = g.getNumVertices();
+    if (n < 2)
+        throw "Graph needs at least two vertices";
+    if (trials < 0)
+        throw "Number of trials must be non-negative";
+    GRAPH_INSTRUMENT_SCOPE("karger_stein");
+    long long count;
+    WeightedEdge* edges = collectEdges(g, count);
+    if (trials == 0)
+        trials = kargerSteinTrials(n, 0.01);
+    UnionFind uf(n);
+    int components = n;
+    for (long long i = 0; i < count; i++)
+        if (!uf.isConnected(edges[i].u, edges[i].v)) {
+            uf.unite(edges[i].u, edges[i].v);
+            components--;
+        }
+    if (components > 1) {
+        if (side) {
+            int root = uf.find(0);
+            for (int v = 0; v < n; v++)
+                side[v] = uf.find(v) == root;
+        }
+        delete[] edges;
+        return 0;
+    }
+    threads = Parallel::resolve(threads);
+    long long* best = new long long[trials];
+    long long* scanned = new long long[trials];
+    bool** sides = new bool*[trials];
+    for (int i = 0; i < trials; i++)
+        sides[i] = 0;
+    // Depth is at most log_sqrt2(n / BaseVertices) + 1 < 128 levels.
+    Parallel::forDynamic(0, trials, 1, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++) {
+            Trial trial;
+            trial.state = seed ^ (static_cast<unsigned long long>(i) * 0xD1B54A32D192ED03ULL);
+            next(trial.state);
+            trial.best = -1ULL >> 1;
+            trial.scanned = 0;
+            trial.side = new bool[n];
+            trial.levelSize = new int[129];
+            trial.leafSide = new bool[BaseVertices];
+            trial.matrix = new long long[BaseVertices * BaseVertices];
+            trial.owner = new int[BaseVertices];
+            trial.levelSize[0] = n;
+            recurse(n, edges, count, 0, trial);
+            best[i] = trial.best;
+            scanned[i] = trial.scanned;
+            sides[i] = trial.side;
+            delete[] trial.levelSize;
+            delete[] trial.leafSide;
+            delete[] trial.matrix;
+            delete[] trial.owner;
+        }
+    });
+    // Counted here: the instrumentation record belongs to the calling thread.
+    for (int i = 0; i < trials; i++)
+        GRAPH_COUNT(edgesScanned, scanned[i]);
+    int winner = 0;
+    for (int i = 1; i < trials; i++)
+        if (best[i] < best[winner])
+            winner = i;
+    long long cut = best[winner];
+    if (side)
+        std::copy(sides[winner], sides[winner] + n, side);
+    for (int i = 0; i < trials; i++)
+        delete[] sides[i];
+    delete[] sides;
+    delete[] best;
+    delete[] scanned;
+    delete[] edges;
+    return cut;
+}
+
+int MinCut::kargerSteinTrials(int vertices, double failure) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    if (failure <= 0 || failure >= 1)
+        throw "Failure probability must be in (0, 1)";
+    double runs = std::ceil(std::log2(vertices > 2 ? vertices : 2) * std::log(1 / failure));
+    return static_cast<int>(runs);
+}
+
+} // namespace graph
+
+#endif // MINCUT_CPP
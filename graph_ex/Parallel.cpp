@@ -0,0 +1,136 @@
+// Parallel.cpp
+#ifndef PARALLEL_CPP
+#define PARALLEL_CPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace graph {
+
+// Minimal fork-join helpers used by the parallel graph routines.
+// The callback receives (threadIndex, lo, hi) and must not throw:
+// inputs are validated before any work is handed to the threads.
+class Parallel {
+public:
+    // Number of hardware threads (at least 1).
+    static int defaultThreads();
+    // Resolves a caller-supplied thread count (0 or less means "all").
+    static int resolve(int threads);
+    // Splits [begin, end) into one contiguous block per thread.
+    template <typename Fn>
+    static void forRange(long long begin, long long end, int threads, Fn fn);
+    // Hands out [begin, end) in blocks of 'grain' on demand, for skewed work.
+    template <typename Fn>
+    static void forDynamic(long long begin, long long end, long long grain, int threads, Fn fn);
+    // Sorts data[0 .. count) with std::sort per block, then merges blocks pairwise.
+    template <typename T>
+    static void sort(T* data, long long count, int threads);
+};
+
+int Parallel::defaultThreads() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+int Parallel::resolve(int threads) {
+    return threads <= 0 ? defaultThreads() : threads;
+}
+
+template <typename Fn>
+void Parallel::forRange(long long begin, long long end, int threads, Fn fn) {
+    long long total = end - begin;
+    if (total <= 0)
+        return;
+    threads = resolve(threads);
+    if (threads > total)
+        threads = static_cast<int>(total);
+    if (threads == 1) {
+        fn(0, begin, end);
+        return;
+    }
+    std::thread* workers = new std::thread[threads - 1];
+    long long chunk = total / threads;
+    long long extra = total % threads;
+    long long lo = begin;
+    for (int t = 0; t < threads; t++) {
+        long long hi = lo + chunk + (t < extra ? 1 : 0);
+        if (t == threads - 1)
+            fn(t, lo, hi); // The calling thread takes the last block.
+        else
+            workers[t] = std::thread([&fn, t, lo, hi]() { fn(t, lo, hi); });
+        lo = hi;
+    }
+    for (int t = 0; t < threads - 1; t++)
+        workers[t].join();
+    delete[] workers;
+}
+
+template <typename Fn>
+void Parallel::forDynamic(long long begin, long long end, long long grain, int threads, Fn fn) {
+    if (end <= begin)
+        return;
+    if (grain <= 0)
+        grain = 1;
+    threads = resolve(threads);
+    long long blocks = (end - begin + grain - 1) / grain;
+    if (threads > blocks)
+        threads = static_cast<int>(blocks);
+    std::atomic<long long> next(begin);
+    auto worker = [&](int t) {
+        while (true) {
+            long long lo = next.fetch_add(grain);
+            if (lo >= end)
+                break;
+            long long hi = lo + grain < end ? lo + grain : end;
+            fn(t, lo, hi);
+        }
+    };
+    if (threads == 1) {
+        worker(0);
+        return;
+    }
+    std::thread* workers = new std::thread[threads - 1];
+    for (int t = 0; t < threads - 1; t++)
+        workers[t] = std::thread(worker, t);
+    worker(threads - 1);
+    for (int t = 0; t < threads - 1; t++)
+        workers[t].join();
+    delete[] workers;
+}
+
+template <typename T>
+void Parallel::sort(T* data, long long count, int threads) {
+    threads = resolve(threads);
+    if (count < 4096 || threads == 1) {
+        std::sort(data, data + count);
+        return;
+    }
+    long long blocks = threads;
+    long long blockSize = (count + blocks - 1) / blocks;
+    forRange(0, blocks, threads, [&](int, long long lo, long long hi) {
+        for (long long b = lo; b < hi; b++) {
+            long long begin = b * blockSize;
+            long long end = begin + blockSize < count ? begin + blockSize : count;
+            if (begin < end)
+                std::sort(data + begin, data + end);
+        }
+    });
+    // Each round merges neighbouring sorted runs of length 'width'.
+    for (long long width = blockSize; width < count; width *= 2) {
+        long long pairs = (count + 2 * width - 1) / (2 * width);
+        forRange(0, pairs, threads, [&](int, long long lo, long long hi) {
+            for (long long p = lo; p < hi; p++) {
+                long long begin = p * 2 * width;
+                long long mid = begin + width < count ? begin + width : count;
+                long long end = begin + 2 * width < count ? begin + 2 * width : count;
+                if (mid < end)
+                    std::inplace_merge(data + begin, data + mid, data + end);
+            }
+        });
+    }
+}
+
+} // namespace graph
+
+#endif // PARALLEL_CPP
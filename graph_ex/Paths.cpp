@@ -0,0 +1,693 @@
+// Paths.cpp
+#ifndef PATHS_CPP
+#define PATHS_CPP
+
+#include "Algorithms.cpp"
+#include "CSRGraph.cpp"
+#include "Instrumentation.cpp"
+#include "Parallel.cpp"
+#include <algorithm>
+
+namespace graph {
+
+// An ordered list of paths, each a vertex sequence with its total weight.
+class PathList {
+public:
+    // Constructors, destructor, and assignment operator.
+    PathList();
+    PathList(const PathList& other);
+    ~PathList();
+    PathList& operator=(PathList other); // Uses copy-swap idiom.
+    friend void swap(PathList& a, PathList& b);
+
+    // Accessors.
+    int size() const;
+    long long length(int i) const;    // Total weight of path i.
+    int count(int i) const;           // Vertices on path i, both ends included.
+    const int* vertices(int i) const; // Path i from source to target.
+
+private:
+    friend class Paths;
+    int numPaths;
+    long long* lengths;
+    long long* offsets; // numPaths + 1 starts into data.
+    int* data;
+};
+
+// Shortest-path queries on weighted undirected graphs. Weights must be
+// non-negative.
+class Paths {
+public:
+    // Up to k shortest simple (loopless) paths from source to target in
+    // non-decreasing length (Yen). Fewer come back when fewer exist. With
+    // threads > 1, the spur searches of each round run in parallel; the
+    // result does not depend on the thread count.
+    static PathList kShortest(const CSRGraph& g, int source, int target, int k, int threads = 1);
+    static PathList kShortest(const Graph& g, int source, int target, int k, int threads = 1);
+    // Many-to-many distances into a row-major numSources x numTargets matrix:
+    // table[i * numTargets + j] = distance from sources[i] to targets[j], or
+    // Unreachable. Sources are searched in parallel, and each search stops as
+    // soon as every target is settled.
+    static void distanceTable(const CSRGraph& g, const int* sources, int numSources, const int* targets,
+                              int numTargets, long long* table, int threads = 0);
+    static void distanceTable(const Graph& g, const int* sources, int numSources, const int* targets,
+                              int numTargets, long long* table, int threads = 0);
+
+    // All-pairs distances into a row-major n x n int matrix: dist[u * n + v],
+    // MAX_INT_VALUE when unreachable. Blocked Floyd-Warshall: each round
+    // closes one diagonal tile, then its row and column tiles, then every
+    // other tile, the tiles of a step in parallel. Throws when a path could
+    // overflow, i.e. (n - 1) * maxWeight >= 2^30 - 1.
+    static void floydWarshall(const CSRGraph& g, int* dist, int threads = 0);
+    static void floydWarshall(const Graph& g, int* dist, int threads = 0);
+
+    static const long long Unreachable; // Distance to a vertex that cannot be reached.
+    // Floyd-Warshall tile edge: three 64 x 64 int tiles fit in a 64 KB L2 slice.
+    static const int Tile = 64;
+
+private:
+    struct Route {
+        long long length;
+        int count;
+        int* vertices;
+        int deviation; // Index of the spur vertex the route branched at.
+    };
+    // Spur searches run in batches of this many, tightening the bound between batches.
+    static const int SpurBatch = 32;
+    // Per-thread Dijkstra state. Only the entries a search touches are
+    // reset afterwards, so a search costs nothing for the vertices it never
+    // reaches.
+    struct Scratch {
+        long long* dist;   // Unreachable when untouched.
+        int* pred;
+        bool* blocked;
+        int* touched;
+        int numTouched;
+        long long* heapKey; // Lazy binary min-heap of (key, vertex).
+        int* heapVertex;
+        long long heapSize;
+        long long heapCapacity;
+        Scratch(int n);
+        ~Scratch();
+        void push(long long key, int v);
+        void pop(long long& key, int& v);
+    };
+    // A* from 'from' to 'to' with the exact distances 'toTarget' of the full
+    // graph as the (consistent) heuristic, avoiding the blocked vertices and
+    // the edges from 'from' to any of banned[0 .. bannedCount). Gives up once
+    // no path can be shorter than 'limit'. On success writes the path to
+    // out and returns its length; otherwise returns Unreachable. Adds the
+    // edges it examines to 'scanned'; callers report them from the thread
+    // that owns the instrumentation scope.
+    static long long spurSearch(const CSRGraph& g, int from, int to, const long long* toTarget, long long limit,
+                                const int* banned, int bannedCount, Scratch& s, int* out, int& outCount,
+                                long long& scanned);
+    // Exact distances from 'source' to every vertex.
+    static void dijkstra(const CSRGraph& g, int source, long long* dist);
+    static void checkWeights(const CSRGraph& g);
+    // Floyd-Warshall tile updates, c[i][j] = min(c[i][j], a[i][k] + b[k][j])
+    // over tiles of a matrix with row length 'stride'. relaxDependent keeps k
+    // outermost, so c may be a or b; relaxIndependent needs three distinct
+    // tiles and keeps j innermost over unit-stride rows, which vectorises.
+    static void relaxDependent(int* c, const int* a, const int* b, int rows, int cols, int depth, long long stride);
+    static void relaxIndependent(int* __restrict__ c, const int* __restrict__ a, const int* __restrict__ b,
+                                 int rows, int cols, int depth, long long stride);
+    static const int Far = (1 << 30) - 1; // Working "infinity"; Far + Far still fits an int.
+};
+
+const long long Paths::Unreachable = 9223372036854775807LL;
+
+PathList::PathList() : numPaths(0), lengths(0), offsets(new long long[1]()), data(0) {}
+
+PathList::PathList(const PathList& other) : numPaths(other.numPaths) {
+    lengths = new long long[numPaths];
+    offsets = new long long[numPaths + 1];
+    data = new int[other.offsets[numPaths]];
+    std::copy(other.lengths, other.lengths + numPaths, lengths);
+    std::copy(other.offsets, other.offsets + numPaths + 1, offsets);
+    std::copy(other.data, other.data + other.offsets[numPaths], data);
+}
+
+PathList::~PathList() {
+    delete[] lengths;
+    delete[] offsets;
+    delete[] data;
+}
+
+void swap(PathList& a, PathList& b) {
+    std::swap(a.numPaths, b.numPaths);
+    std::swap(a.lengths, b.lengths);
+    std::swap(a.offsets, b.offsets);
+    std::swap(a.data, b.data);
+}
+
+PathList& PathList::operator=(PathList other) {
+    swap(*this, other);
+    return *this;
+}
+
+int PathList::size() const {
+    return numPaths;
+}
+
+long long PathList::length(int i) const {
+    if (i < 0 || i >= numPaths)
+        throw "Path index out of range";
+    return lengths[i];
+}
+
+int PathList::count(int i) const {
+    if (i < 0 || i >= numPaths)
+        throw "Path index out of range";
+    return static_cast<int>(offsets[i + 1] - offsets[i]);
+}
+
+const int* PathList::vertices(int i) const {
+    if (i < 0 || i >= numPaths)
+        throw "Path index out of range";
+    return data + offsets[i];
+}
+
+Paths::Scratch::Scratch(int n) : numTouched(0), heapSize(0), heapCapacity(n + 1) {
+    dist = new long long[n];
+    pred = new int[n];
+    blocked = new bool[n]();
+    touched = new int[n];
+    heapKey = new long long[heapCapacity];
+    heapVertex = new int[heapCapacity];
+    for (int v = 0; v < n; v++)
+        dist[v] = Unreachable;
+}
+
+Paths::Scratch::~Scratch() {
+    delete[] dist;
+    delete[] pred;
+    delete[] blocked;
+    delete[] touched;
+    delete[] heapKey;
+    delete[] heapVertex;
+}
+
+// push: grows the heap by doubling when full.
+void Paths::Scratch::push(long long key, int v) {
+    if (heapSize == heapCapacity) {
+        long long capacity = 2 * heapCapacity;
+        long long* keys = new long long[capacity];
+        int* vertices = new int[capacity];
+        std::copy(heapKey, heapKey + heapSize, keys);
+        std::copy(heapVertex, heapVertex + heapSize, vertices);
+        delete[] heapKey;
+        delete[] heapVertex;
+        heapKey = keys;
+        heapVertex = vertices;
+        heapCapacity = capacity;
+    }
+    long long i = heapSize++;
+    while (i > 0 && heapKey[(i - 1) / 2] > key) {
+        heapKey[i] = heapKey[(i - 1) / 2];
+        heapVertex[i] = heapVertex[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heapKey[i] = key;
+    heapVertex[i] = v;
+}
+
+void Paths::Scratch::pop(long long& key, int& v) {
+    key = heapKey[0];
+    v = heapVertex[0];
+    long long lastKey = heapKey[--heapSize];
+    int lastVertex = heapVertex[heapSize];
+    long long i = 0;
+    while (2 * i + 1 < heapSize) {
+        long long c = 2 * i + 1;
+        if (c + 1 < heapSize && heapKey[c + 1] < heapKey[c])
+            c++;
+        if (heapKey[c] >= lastKey)
+            break;
+        heapKey[i] = heapKey[c];
+        heapVertex[i] = heapVertex[c];
+        i = c;
+    }
+    heapKey[i] = lastKey;
+    heapVertex[i] = lastVertex;
+}
+
+void Paths::checkWeights(const CSRGraph& g) {
+    for (long long e = 0; e < g.getNumEntries(); e++)
+        if (g.getWeights()[e] < 0)
+            throw "Negative edge weight";
+}
+
+// dijkstra: lazy-deletion heap over a Scratch; the distances are copied out.
+void Paths::dijkstra(const CSRGraph& g, int source, long long* dist) {
+    int n = g.getNumVertices();
+    Scratch s(n);
+    long long* zero = new long long[n]();
+    int* out = new int[n];
+    int outCount;
+    long long scanned = 0;
+    spurSearch(g, source, -1, zero, Unreachable, 0, 0, s, out, outCount, scanned);
+    GRAPH_COUNT(edgesScanned, scanned);
+    std::copy(s.dist, s.dist + n, dist);
+    delete[] zero;
+    delete[] out;
+}
+
+// spurSearch: keys are dist + toTarget, so the search heads for 'to' and a
+// vertex whose key reaches 'limit' is never expanded. With to == -1 it
+// settles everything reachable and leaves the distances in s.dist for the
+// caller (who must not reuse s afterwards).
+long long Paths::spurSearch(const CSRGraph& g, int from, int to, const long long* toTarget, long long limit,
+                            const int* banned, int bannedCount, Scratch& s, int* out, int& outCount,
+                            long long& scanned) {
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    const int* weights = g.getWeights();
+    long long result = Unreachable;
+    s.numTouched = 0;
+    s.dist[from] = 0;
+    s.pred[from] = -1;
+    s.touched[s.numTouched++] = from;
+    s.heapSize = 0;
+    s.push(toTarget[from], from);
+    long long examined = 0;
+    while (s.heapSize > 0) {
+        long long key;
+        int u;
+        s.pop(key, u);
+        if (key >= limit)
+            break;
+        if (key != s.dist[u] + toTarget[u])
+            continue; // Stale entry.
+        if (u == to) {
+            result = s.dist[u];
+            break;
+        }
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = targets[e];
+            examined++;
+            if (s.blocked[v] || toTarget[v] == Unreachable)
+                continue;
+            if (u == from && std::find(banned, banned + bannedCount, v) != banned + bannedCount)
+                continue;
+            long long candidate = s.dist[u] + weights[e];
+            if (candidate < s.dist[v]) {
+                if (s.dist[v] == Unreachable)
+                    s.touched[s.numTouched++] = v;
+                s.dist[v] = candidate;
+                s.pred[v] = u;
+                s.push(candidate + toTarget[v], v);
+            }
+        }
+    }
+    scanned += examined;
+    outCount = 0;
+    if (result != Unreachable) {
+        for (int v = to; v != -1; v = s.pred[v])
+            out[outCount++] = v;
+        std::reverse(out, out + outCount);
+    }
+    if (to >= 0)
+        for (int i = 0; i < s.numTouched; i++)
+            s.dist[s.touched[i]] = Unreachable;
+    return result;
+}
+
+// kShortest: Yen's algorithm. Path i + 1 is the best candidate so far, and
+// the candidates come from the spur searches of path i: for each spur vertex
+// along it, the prefix up to the spur is kept, the prefix vertices are
+// blocked and the edges that earlier paths with the same prefix take out of
+// the spur are banned. Only spurs from the vertex where path i branched off
+// onwards are searched (Lawler); earlier ones would repeat its parent's. The
+// searches are A* guided by exact distances to the target, in batches from
+// the target end backwards, and each batch is bounded by the candidate that
+// would already complete the k paths, so most searches stop early or are
+// skipped outright. Batches do not depend on the thread count.
+PathList Paths::kShortest(const CSRGraph& g, int source, int target, int k, int threads) {
+    int n = g.getNumVertices();
+    if (source < 0 || source >= n || target < 0 || target >= n)
+        throw "Vertex index out of range";
+    if (k < 0)
+        throw "k must be non-negative";
+    checkWeights(g);
+    GRAPH_INSTRUMENT_SCOPE("k_shortest_paths");
+    threads = Parallel::resolve(threads);
+    long long* toTarget = new long long[n];
+    dijkstra(g, target, toTarget);
+    Route* found = new Route[k + 1];
+    int numFound = 0;
+    // Candidates, kept sorted by length (stable, so ties keep their order).
+    int candidateCapacity = 16, numCandidates = 0;
+    Route* candidates = new Route[candidateCapacity];
+    Scratch** scratch = new Scratch*[threads];
+    int** outs = new int*[threads];
+    long long* partialScanned = new long long[threads];
+    for (int t = 0; t < threads; t++) {
+        scratch[t] = new Scratch(n);
+        outs[t] = new int[n];
+    }
+    if (k > 0 && toTarget[source] != Unreachable) {
+        int count;
+        long long scanned = 0;
+        long long length = spurSearch(g, source, target, toTarget, Unreachable, 0, 0, *scratch[0], outs[0], count,
+                                      scanned);
+        GRAPH_COUNT(edgesScanned, scanned);
+        Route first = {length, count, new int[count], 0};
+        std::copy(outs[0], outs[0] + count, first.vertices);
+        found[numFound++] = first;
+    }
+    while (numFound > 0 && numFound < k) {
+        const Route& last = found[numFound - 1];
+        int spurs = last.count - 1;
+        // prefix[j] = length of last up to its j-th vertex (lightest parallel edges).
+        long long* prefix = new long long[last.count];
+        prefix[0] = 0;
+        for (int i = 0; i < spurs; i++) {
+            int a = last.vertices[i], b = last.vertices[i + 1];
+            long long lightest = Unreachable;
+            for (long long e = g.getOffsets()[a]; e < g.getOffsets()[a + 1]; e++)
+                if (g.getTargets()[e] == b && g.getWeights()[e] < lightest)
+                    lightest = g.getWeights()[e];
+            prefix[i + 1] = prefix[i] + lightest;
+        }
+        Route* spurRoutes = new Route[spurs];
+        for (int batchEnd = spurs; batchEnd > last.deviation; batchEnd -= SpurBatch) {
+            int batchBegin = std::max(last.deviation, batchEnd - SpurBatch);
+            // Enough candidates already beat any length at or above this.
+            int need = k - numFound;
+            long long limit = numCandidates >= need ? candidates[need - 1].length : Unreachable;
+            for (int t = 0; t < threads; t++)
+                partialScanned[t] = 0;
+            Parallel::forDynamic(batchBegin, batchEnd, 1, threads, [&](int t, long long lo, long long hi) {
+                Scratch& s = *scratch[t];
+                int* out = outs[t];
+                int* banned = new int[numFound];
+                for (long long j = lo; j < hi; j++) {
+                    spurRoutes[j].vertices = 0;
+                    int spur = last.vertices[j];
+                    long long rootLength = prefix[j];
+                    if (toTarget[spur] == Unreachable || rootLength + toTarget[spur] >= limit)
+                        continue;
+                    int bannedCount = 0;
+                    for (int p = 0; p < numFound; p++) {
+                        const Route& r = found[p];
+                        if (r.count > j + 1 && std::equal(r.vertices, r.vertices + j + 1, last.vertices))
+                            banned[bannedCount++] = r.vertices[j + 1];
+                    }
+                    for (long long i = 0; i < j; i++)
+                        s.blocked[last.vertices[i]] = true;
+                    int count;
+                    long long spurLimit = limit == Unreachable ? limit : limit - rootLength;
+                    long long spurLength = spurSearch(g, spur, target, toTarget, spurLimit, banned, bannedCount, s,
+                                                      out, count, partialScanned[t]);
+                    for (long long i = 0; i < j; i++)
+                        s.blocked[last.vertices[i]] = false;
+                    if (spurLength == Unreachable)
+                        continue;
+                    Route r = {rootLength + spurLength, static_cast<int>(j) + count, new int[j + count],
+                               static_cast<int>(j)};
+                    std::copy(last.vertices, last.vertices + j, r.vertices);
+                    std::copy(out, out + count, r.vertices + j);
+                    spurRoutes[j] = r;
+                }
+                delete[] banned;
+            });
+            for (int t = 0; t < threads; t++)
+                GRAPH_COUNT(edgesScanned, partialScanned[t]);
+            // Merge in spur order, dropping duplicates.
+            for (int j = batchBegin; j < batchEnd; j++) {
+                Route r = spurRoutes[j];
+                if (!r.vertices)
+                    continue;
+                bool duplicate = false;
+                for (int c = 0; c < numCandidates && !duplicate; c++)
+                    duplicate = candidates[c].count == r.count &&
+                                std::equal(r.vertices, r.vertices + r.count, candidates[c].vertices);
+                if (duplicate) {
+                    delete[] r.vertices;
+                    continue;
+                }
+                if (numCandidates == candidateCapacity) {
+                    Route* bigger = new Route[2 * candidateCapacity];
+                    std::copy(candidates, candidates + numCandidates, bigger);
+                    delete[] candidates;
+                    candidates = bigger;
+                    candidateCapacity *= 2;
+                }
+                int pos = numCandidates++;
+                while (pos > 0 && candidates[pos - 1].length > r.length) {
+                    candidates[pos] = candidates[pos - 1];
+                    pos--;
+                }
+                candidates[pos] = r;
+            }
+        }
+        delete[] spurRoutes;
+        delete[] prefix;
+        if (numCandidates == 0)
+            break;
+        found[numFound++] = candidates[0];
+        std::copy(candidates + 1, candidates + numCandidates, candidates);
+        numCandidates--;
+    }
+    PathList result;
+    delete[] result.offsets;
+    result.numPaths = numFound;
+    result.lengths = new long long[numFound];
+    result.offsets = new long long[numFound + 1];
+    result.offsets[0] = 0;
+    for (int i = 0; i < numFound; i++) {
+        result.lengths[i] = found[i].length;
+        result.offsets[i + 1] = result.offsets[i] + found[i].count;
+    }
+    result.data = new int[result.offsets[numFound]];
+    for (int i = 0; i < numFound; i++) {
+        std::copy(found[i].vertices, found[i].vertices + found[i].count, result.data + result.offsets[i]);
+        delete[] found[i].vertices;
+    }
+    for (int c = 0; c < numCandidates; c++)
+        delete[] candidates[c].vertices;
+    for (int t = 0; t < threads; t++) {
+        delete scratch[t];
+        delete[] outs[t];
+    }
+    delete[] scratch;
+    delete[] outs;
+    delete[] partialScanned;
+    delete[] found;
+    delete[] candidates;
+    delete[] toTarget;
+    return result;
+}
+
+PathList Paths::kShortest(const Graph& g, int source, int target, int k, int threads) {
+    return kShortest(CSRGraph::fromGraph(g, threads), source, target, k, threads);
+}
+
+// distanceTable: one Dijkstra per source on a per-thread Scratch, counting
+// down the distinct targets as they are settled. Settled distances are final,
+// so a row can be read as soon as the count reaches zero (or the heap runs
+// dry); only the touched entries are reset for the next source.
+void Paths::distanceTable(const CSRGraph& g, const int* sources, int numSources, const int* targets,
+                          int numTargets, long long* table, int threads) {
+    int n = g.getNumVertices();
+    if (numSources < 0 || numTargets < 0)
+        throw "Counts must be non-negative";
+    for (int i = 0; i < numSources; i++)
+        if (sources[i] < 0 || sources[i] >= n)
+            throw "Vertex index out of range";
+    for (int j = 0; j < numTargets; j++)
+        if (targets[j] < 0 || targets[j] >= n)
+            throw "Vertex index out of range";
+    checkWeights(g);
+    if (numSources == 0 || numTargets == 0)
+        return;
+    GRAPH_INSTRUMENT_SCOPE("distance_table");
+    const long long* offsets = g.getOffsets();
+    const int* adjacent = g.getTargets();
+    const int* weights = g.getWeights();
+    bool* isTarget = new bool[n]();
+    int distinct = 0;
+    for (int j = 0; j < numTargets; j++)
+        if (!isTarget[targets[j]]) {
+            isTarget[targets[j]] = true;
+            distinct++;
+        }
+    threads = Parallel::resolve(threads);
+    if (threads > numSources)
+        threads = numSources;
+    Scratch** scratch = new Scratch*[threads];
+    long long* partialScanned = new long long[threads]();
+    for (int t = 0; t < threads; t++)
+        scratch[t] = new Scratch(n);
+    Parallel::forDynamic(0, numSources, 1, threads, [&](int t, long long lo, long long hi) {
+        Scratch& s = *scratch[t];
+        long long scanned = 0;
+        for (long long i = lo; i < hi; i++) {
+            int source = sources[i];
+            s.numTouched = 0;
+            s.heapSize = 0;
+            s.dist[source] = 0;
+            s.touched[s.numTouched++] = source;
+            s.push(0, source);
+            int remaining = distinct;
+            while (s.heapSize > 0 && remaining > 0) {
+                long long key;
+                int u;
+                s.pop(key, u);
+                if (key != s.dist[u])
+                    continue; // Stale entry.
+                if (isTarget[u])
+                    remaining--;
+                for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                    int v = adjacent[e];
+                    long long candidate = key + weights[e];
+                    if (candidate < s.dist[v]) {
+                        if (s.dist[v] == Unreachable)
+                            s.touched[s.numTouched++] = v;
+                        s.dist[v] = candidate;
+                        s.push(candidate, v);
+                    }
+                }
+                scanned += offsets[u + 1] - offsets[u];
+            }
+            long long* row = table + i * numTargets;
+            for (int j = 0; j < numTargets; j++)
+                row[j] = s.dist[targets[j]];
+            for (int j = 0; j < s.numTouched; j++)
+                s.dist[s.touched[j]] = Unreachable;
+        }
+        partialScanned[t] += scanned;
+    });
+    for (int t = 0; t < threads; t++) {
+        GRAPH_COUNT(edgesScanned, partialScanned[t]);
+        delete scratch[t];
+    }
+    delete[] scratch;
+    delete[] partialScanned;
+    delete[] isTarget;
+}
+
+void Paths::distanceTable(const Graph& g, const int* sources, int numSources, const int* targets, int numTargets,
+                          long long* table, int threads) {
+    distanceTable(CSRGraph::fromGraph(g, threads), sources, numSources, targets, numTargets, table, threads);
+}
+
+void Paths::relaxDependent(int* c, const int* a, const int* b, int rows, int cols, int depth, long long stride) {
+    for (int k = 0; k < depth; k++) {
+        const int* bk = b + k * stride;
+        for (int i = 0; i < rows; i++) {
+            int aik = a[i * stride + k];
+            int* ci = c + i * stride;
+            for (int j = 0; j < cols; j++) {
+                int through = aik + bk[j];
+                ci[j] = through < ci[j] ? through : ci[j];
+            }
+        }
+    }
+}
+
+void Paths::relaxIndependent(int* __restrict__ c, const int* __restrict__ a, const int* __restrict__ b,
+                             int rows, int cols, int depth, long long stride) {
+    for (int i = 0; i < rows; i++) {
+        int* ci = c + i * stride;
+        for (int k = 0; k < depth; k++) {
+            int aik = a[i * stride + k];
+            if (aik >= Far)
+                continue;
+            const int* bk = b + k * stride;
+            if (cols == Tile) {
+                // Constant trip count: vectorised even at -O2.
+                for (int j = 0; j < Tile; j++) {
+                    int through = aik + bk[j];
+                    ci[j] = through < ci[j] ? through : ci[j];
+                }
+            } else {
+                for (int j = 0; j < cols; j++) {
+                    int through = aik + bk[j];
+                    ci[j] = through < ci[j] ? through : ci[j];
+                }
+            }
+        }
+    }
+}
+
+// floydWarshall: the matrix is worked in place as Tile x Tile blocks (the
+// last row and column of blocks may be narrower). Values at or above Far
+// mean "no path" and stay there, since Far + Far does not overflow and every
+// real distance is below Far.
+void Paths::floydWarshall(const CSRGraph& g, int* dist, int threads) {
+    int n = g.getNumVertices();
+    checkWeights(g);
+    long long maxWeight = 0;
+    for (long long e = 0; e < g.getNumEntries(); e++)
+        if (g.getWeights()[e] > maxWeight)
+            maxWeight = g.getWeights()[e];
+    if ((n - 1) * maxWeight >= Far)
+        throw "Path lengths may overflow";
+    GRAPH_INSTRUMENT_SCOPE("floyd_warshall");
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    const int* weights = g.getWeights();
+    long long stride = n;
+    Parallel::forRange(0, n, threads, [&](int, long long lo, long long hi) {
+        for (long long u = lo; u < hi; u++) {
+            int* row = dist + u * stride;
+            for (int v = 0; v < n; v++)
+                row[v] = Far;
+            row[u] = 0;
+            for (long long e = offsets[u]; e < offsets[u + 1]; e++)
+                if (weights[e] < row[targets[e]])
+                    row[targets[e]] = weights[e];
+        }
+    });
+    int blocks = (n + Tile - 1) / Tile;
+    auto tile = [&](int bi, int bj) { return dist + bi * Tile * stride + bj * Tile; };
+    auto extent = [&](int b) { return n - b * Tile < Tile ? n - b * Tile : Tile; };
+    for (int kb = 0; kb < blocks; kb++) {
+        int depth = extent(kb);
+        int* pivot = tile(kb, kb);
+        relaxDependent(pivot, pivot, pivot, depth, depth, depth, stride);
+        // Row and column tiles of the pivot: tile t < blocks - 1 is row tile
+        // (kb, t'), the rest column tiles (t', kb), skipping t' == kb.
+        Parallel::forDynamic(0, 2 * (blocks - 1), 1, threads, [&](int, long long lo, long long hi) {
+            for (long long t = lo; t < hi; t++) {
+                int other = static_cast<int>(t % (blocks - 1));
+                if (other >= kb)
+                    other++;
+                if (t < blocks - 1) {
+                    int* c = tile(kb, other);
+                    relaxDependent(c, pivot, c, depth, extent(other), depth, stride);
+                } else {
+                    int* c = tile(other, kb);
+                    relaxDependent(c, c, pivot, extent(other), depth, depth, stride);
+                }
+            }
+        });
+        long long others = static_cast<long long>(blocks - 1) * (blocks - 1);
+        Parallel::forDynamic(0, others, 1, threads, [&](int, long long lo, long long hi) {
+            for (long long t = lo; t < hi; t++) {
+                int bi = static_cast<int>(t / (blocks - 1)), bj = static_cast<int>(t % (blocks - 1));
+                if (bi >= kb)
+                    bi++;
+                if (bj >= kb)
+                    bj++;
+                relaxIndependent(tile(bi, bj), tile(bi, kb), tile(kb, bj), extent(bi), extent(bj), depth, stride);
+            }
+        });
+    }
+    GRAPH_COUNT(edgesScanned, g.getNumEntries());
+    Parallel::forRange(0, static_cast<long long>(n) * n, threads, [&](int, long long lo, long long hi) {
+        for (long long i = lo; i < hi; i++)
+            if (dist[i] >= Far)
+                dist[i] = MAX_INT_VALUE;
+    });
+}
+
+void Paths::floydWarshall(const Graph& g, int* dist, int threads) {
+    floydWarshall(CSRGraph::fromGraph(g, threads), dist, threads);
+}
+
+} // namespace graph
+
+#endif // PATHS_CPP
@@ -0,0 +1,297 @@
+// SmallGraph.cpp
+#ifndef SMALLGRAPH_CPP
+#define SMALLGRAPH_CPP
+
+#include "Graph.cpp"
+
+namespace graph {
+
+// Undirected weighted graph with at most N <= 64 vertices, stored entirely
+// inside the object: one 64-bit neighbour mask and one weight row per vertex.
+// Intended for tiny graphs built per request (local neighbourhoods), where
+// the heap allocations of Graph, Queue, PriorityQueue and UnionFind would
+// dominate. No member allocates; results are returned as SmallGraph::Tree
+// values. Parallel edges collapse to the lightest one, as in DenseGraph.
+template <int N>
+class SmallGraph {
+    static_assert(N >= 1 && N <= 64, "SmallGraph supports 1 to 64 vertices");
+
+public:
+    static const int Capacity = N;
+
+    // Result of a traversal: a rooted tree or forest over the vertices.
+    struct Tree {
+        int numVertices;
+        int parent[N]; // -1 for roots and unreached vertices.
+        int weight[N]; // Weight of the edge to the parent.
+        int dist[N];   // Hops (bfs, dfs), distance (dijkstra) or key (prim); -1 if unreached.
+
+        int getNumEdges() const;
+        Graph toGraph() const; // Allocates; for interop only.
+    };
+
+    explicit SmallGraph(int vertices = N);
+    static SmallGraph fromGraph(const Graph& g);
+    Graph toGraph() const; // Allocates; for interop only.
+
+    // Graph operations. Adding an existing edge keeps the lighter weight.
+    void addEdge(int source, int dest, int weight = 1);
+    void removeEdge(int source, int dest);
+    bool hasEdge(int source, int dest) const;
+    int getWeight(int source, int dest) const;
+
+    // Algorithms (same trees as the Algorithms versions, up to ties).
+    Tree bfs(int source) const;
+    Tree dfs(int source) const;
+    Tree dijkstra(int source) const; // Non-negative weights.
+    Tree prim() const;               // Starts at vertex 0, then other components.
+
+    // Accessors.
+    int getNumVertices() const;
+    int getDegree(int vertex) const;             // Distinct neighbours.
+    unsigned long long neighbors(int vertex) const; // Bit v set if adjacent to v.
+
+private:
+    int numVertices;
+    unsigned long long adjacency[N];
+    int weights[N][N]; // Valid where the adjacency bit is set.
+
+    void checkVertex(int vertex) const;
+    static unsigned long long bit(int v) { return 1ULL << v; }
+    static int lowest(unsigned long long mask) { return __builtin_ctzll(mask); }
+    Tree emptyTree() const;
+};
+
+template <int N>
+SmallGraph<N>::SmallGraph(int vertices) : numVertices(vertices) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    if (vertices > N)
+        throw "Too many vertices for a small graph";
+    for (int v = 0; v < N; v++)
+        adjacency[v] = 0;
+}
+
+template <int N>
+SmallGraph<N> SmallGraph<N>::fromGraph(const Graph& g) {
+    SmallGraph s(g.getNumVertices());
+    for (int u = 0; u < s.numVertices; u++)
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next)
+            if (u <= e->destination)
+                s.addEdge(u, e->destination, e->weight);
+    return s;
+}
+
+template <int N>
+Graph SmallGraph<N>::toGraph() const {
+    Graph g(numVertices);
+    for (int u = 0; u < numVertices; u++)
+        for (unsigned long long m = adjacency[u] & (~0ULL << u); m; m &= m - 1)
+            g.addEdge(u, lowest(m), weights[u][lowest(m)]);
+    return g;
+}
+
+template <int N>
+void SmallGraph<N>::checkVertex(int vertex) const {
+    if (vertex < 0 || vertex >= numVertices)
+        throw "Vertex index out of range";
+}
+
+template <int N>
+void SmallGraph<N>::addEdge(int source, int dest, int weight) {
+    checkVertex(source);
+    checkVertex(dest);
+    if ((adjacency[source] & bit(dest)) && weights[source][dest] <= weight)
+        return;
+    adjacency[source] |= bit(dest);
+    adjacency[dest] |= bit(source);
+    weights[source][dest] = weights[dest][source] = weight;
+}
+
+template <int N>
+void SmallGraph<N>::removeEdge(int source, int dest) {
+    if (!hasEdge(source, dest))
+        throw "Edge does not exist";
+    adjacency[source] &= ~bit(dest);
+    adjacency[dest] &= ~bit(source);
+}
+
+template <int N>
+bool SmallGraph<N>::hasEdge(int source, int dest) const {
+    checkVertex(source);
+    checkVertex(dest);
+    return (adjacency[source] & bit(dest)) != 0;
+}
+
+template <int N>
+int SmallGraph<N>::getWeight(int source, int dest) const {
+    if (!hasEdge(source, dest))
+        throw "Edge does not exist";
+    return weights[source][dest];
+}
+
+template <int N>
+typename SmallGraph<N>::Tree SmallGraph<N>::emptyTree() const {
+    Tree t;
+    t.numVertices = numVertices;
+    for (int v = 0; v < numVertices; v++) {
+        t.parent[v] = -1;
+        t.weight[v] = 0;
+        t.dist[v] = -1;
+    }
+    return t;
+}
+
+// bfs: one mask per level; each frontier vertex claims its unvisited neighbours.
+template <int N>
+typename SmallGraph<N>::Tree SmallGraph<N>::bfs(int source) const {
+    if (source < 0 || source >= numVertices)
+        throw "Source vertex out of range";
+    Tree t = emptyTree();
+    t.dist[source] = 0;
+    unsigned long long visited = bit(source), frontier = bit(source);
+    for (int level = 1; frontier; level++) {
+        unsigned long long next = 0;
+        for (unsigned long long f = frontier; f; f &= f - 1) {
+            int u = lowest(f);
+            unsigned long long fresh = adjacency[u] & ~visited;
+            visited |= fresh;
+            next |= fresh;
+            for (; fresh; fresh &= fresh - 1) {
+                int v = lowest(fresh);
+                t.parent[v] = u;
+                t.weight[v] = weights[u][v];
+                t.dist[v] = level;
+            }
+        }
+        frontier = next;
+    }
+    return t;
+}
+
+// dfs: the path from the root lives in a fixed array; a vertex is popped once
+// it has no unvisited neighbour left.
+template <int N>
+typename SmallGraph<N>::Tree SmallGraph<N>::dfs(int source) const {
+    if (source < 0 || source >= numVertices)
+        throw "Source vertex out of range";
+    Tree t = emptyTree();
+    int stack[N];
+    int top = 0;
+    stack[0] = source;
+    t.dist[source] = 0;
+    unsigned long long visited = bit(source);
+    while (top >= 0) {
+        int u = stack[top];
+        unsigned long long fresh = adjacency[u] & ~visited;
+        if (!fresh) {
+            top--;
+            continue;
+        }
+        int v = lowest(fresh);
+        visited |= bit(v);
+        t.parent[v] = u;
+        t.weight[v] = weights[u][v];
+        t.dist[v] = t.dist[u] + 1;
+        stack[++top] = v;
+    }
+    return t;
+}
+
+// dijkstra: O(n^2) selection over the mask of unsettled, reached vertices.
+template <int N>
+typename SmallGraph<N>::Tree SmallGraph<N>::dijkstra(int source) const {
+    if (source < 0 || source >= numVertices)
+        throw "Source vertex out of range";
+    Tree t = emptyTree();
+    t.dist[source] = 0;
+    unsigned long long reached = bit(source), settled = 0;
+    while (reached & ~settled) {
+        int u = -1;
+        for (unsigned long long m = reached & ~settled; m; m &= m - 1)
+            if (u < 0 || t.dist[lowest(m)] < t.dist[u])
+                u = lowest(m);
+        settled |= bit(u);
+        for (unsigned long long m = adjacency[u] & ~settled; m; m &= m - 1) {
+            int v = lowest(m);
+            int candidate = t.dist[u] + weights[u][v];
+            if (!(reached & bit(v)) || candidate < t.dist[v]) {
+                reached |= bit(v);
+                t.dist[v] = candidate;
+                t.parent[v] = u;
+                t.weight[v] = weights[u][v];
+            }
+        }
+    }
+    return t;
+}
+
+// prim: like dijkstra with edge weights as keys. When a component is done the
+// lowest-numbered vertex outside the tree starts the next one.
+template <int N>
+typename SmallGraph<N>::Tree SmallGraph<N>::prim() const {
+    Tree t = emptyTree();
+    unsigned long long all = numVertices == 64 ? ~0ULL : bit(numVertices) - 1;
+    unsigned long long reached = 0, inTree = 0;
+    while (inTree != all) {
+        if (!(reached & ~inTree)) {
+            int root = lowest(all & ~inTree);
+            reached |= bit(root);
+            t.dist[root] = 0;
+        }
+        int u = -1;
+        for (unsigned long long m = reached & ~inTree; m; m &= m - 1)
+            if (u < 0 || t.dist[lowest(m)] < t.dist[u])
+                u = lowest(m);
+        inTree |= bit(u);
+        for (unsigned long long m = adjacency[u] & ~inTree; m; m &= m - 1) {
+            int v = lowest(m);
+            if (!(reached & bit(v)) || weights[u][v] < t.dist[v]) {
+                reached |= bit(v);
+                t.dist[v] = weights[u][v];
+                t.parent[v] = u;
+                t.weight[v] = weights[u][v];
+            }
+        }
+    }
+    return t;
+}
+
+template <int N>
+int SmallGraph<N>::getNumVertices() const {
+    return numVertices;
+}
+
+template <int N>
+int SmallGraph<N>::getDegree(int vertex) const {
+    checkVertex(vertex);
+    return __builtin_popcountll(adjacency[vertex]);
+}
+
+template <int N>
+unsigned long long SmallGraph<N>::neighbors(int vertex) const {
+    checkVertex(vertex);
+    return adjacency[vertex];
+}
+
+template <int N>
+int SmallGraph<N>::Tree::getNumEdges() const {
+    int edges = 0;
+    for (int v = 0; v < numVertices; v++)
+        if (parent[v] != -1)
+            edges++;
+    return edges;
+}
+
+template <int N>
+Graph SmallGraph<N>::Tree::toGraph() const {
+    Graph g(numVertices);
+    for (int v = 0; v < numVertices; v++)
+        if (parent[v] != -1)
+            g.addEdge(parent[v], v, weight[v]);
+    return g;
+}
+
+} // namespace graph
+
+#endif // SMALLGRAPH_CPP
@@ -0,0 +1,332 @@
+// SpMV.cpp
+#ifndef SPMV_CPP
+#define SPMV_CPP
+
+#include "CSRGraph.cpp"
+#include "Parallel.cpp"
+
+namespace graph {
+
+// Semirings for SpMV::multiply. Each supplies the value type, the additive
+// identity zero(), add (the reduction over neighbours), multiply (combines a
+// neighbour's value with the edge weight), and terminal(a), which is true
+// once no further add can change a (pull rows stop scanning there).
+// Semirings whose terminal() is always false set Scan, and their pull rows
+// run four independent accumulators so the neighbour gathers overlap.
+
+// Reachability / BFS: OR over neighbours, weights ignored.
+struct BooleanSemiring {
+    typedef unsigned char Value;
+    static Value zero() { return 0; }
+    static Value add(Value a, Value b) { return a | b; }
+    static Value multiply(Value x, int) { return x; }
+    static bool terminal(Value a) { return a != 0; }
+    static const bool Scan = false;
+};
+
+// Shortest paths: min over neighbours of value + weight.
+struct MinPlusSemiring {
+    typedef long long Value;
+    static Value zero() { return 9223372036854775807LL; } // "Unreachable".
+    static Value add(Value a, Value b) { return b < a ? b : a; }
+    static Value multiply(Value x, int w) { return x == zero() ? x : x + w; }
+    static bool terminal(Value) { return false; }
+    static const bool Scan = true;
+};
+
+// Weighted sums: sum over neighbours of value * weight.
+struct PlusTimesSemiring {
+    typedef double Value;
+    static Value zero() { return 0.0; }
+    static Value add(Value a, Value b) { return a + b; }
+    static Value multiply(Value x, int w) { return x * w; }
+    static bool terminal(Value) { return false; }
+    static const bool Scan = true;
+};
+
+// Unweighted sums: sum of neighbour values (Centrality::pageRank's step).
+struct PlusFirstSemiring {
+    typedef double Value;
+    static Value zero() { return 0.0; }
+    static Value add(Value a, Value b) { return a + b; }
+    static Value multiply(Value x, int) { return x; }
+    static bool terminal(Value) { return false; }
+    static const bool Scan = true;
+};
+
+// Masked sparse matrix-vector products over a symmetric CSRGraph, with the
+// semiring fixed at compile time, plus traversals written on top of them.
+// multiply() pushes from the active entries of x (SpMSpV) while they touch
+// few edges and switches to pulling over every row (SpMV, in parallel) once
+// they don't.
+class SpMV {
+public:
+    // Rows of y that a product may write: mask[v] (or !mask[v] when
+    // complemented); a null mask allows every row.
+    struct Mask {
+        const bool* values;
+        bool complement;
+        bool allows(int v) const { return !values || values[v] != complement; }
+    };
+    static Mask all() { Mask m = {0, false}; return m; }
+
+    // Reusable scratch for multiply(); keep one per traversal.
+    class Workspace {
+    public:
+        explicit Workspace(int vertices);
+        ~Workspace();
+        Workspace(const Workspace&) = delete;
+        Workspace& operator=(const Workspace&) = delete;
+    private:
+        friend class SpMV;
+        int size;
+        unsigned char* marks; // All zero between calls.
+    };
+
+    enum Direction { Auto, Push, Pull };
+    // Pull once the active entries' edges exceed 1/PullFactor of all entries.
+    static const int PullFactor = 14;
+
+    // y[v] = add(y[v], add over u in N(v) of multiply(x[u], w(u, v))) for every
+    // row v the mask allows. x must be zero() outside active[0 .. activeCount)
+    // and must not alias y.
+    // The rows whose value changed are written to 'changed' (capacity n);
+    // returns how many there are. 'used' reports the direction taken.
+    template <typename S>
+    static long long multiply(const CSRGraph& a, const typename S::Value* x, const int* active, long long activeCount,
+                              typename S::Value* y, Mask mask, int* changed, Workspace& ws,
+                              int threads = 0, Direction direction = Auto, Direction* used = 0);
+
+    // Hop distance from the nearest source (-1 if unreachable); returns the number reached.
+    static long long bfsLevels(const CSRGraph& a, const int* sources, int count, int* level, int threads = 0);
+    static long long bfsLevels(const CSRGraph& a, int source, int* level, int threads = 0);
+    // reached[v] = whether v is connected to some source; returns how many are.
+    static long long reachable(const CSRGraph& a, const int* sources, int count, bool* reached, int threads = 0);
+    // Min-plus relaxation until nothing changes (non-negative weights); dist is
+    // MinPlusSemiring::zero() for unreachable vertices. Returns the rounds run.
+    static int sssp(const CSRGraph& a, int source, long long* dist, int threads = 0);
+
+private:
+    template <typename S>
+    static long long pushRows(const CSRGraph& a, const typename S::Value* x, const int* active, long long activeCount,
+                              typename S::Value* y, Mask mask, int* changed, Workspace& ws);
+    template <typename S>
+    static long long pullRows(const CSRGraph& a, const typename S::Value* x, typename S::Value* y,
+                              Mask mask, int* changed, Workspace& ws, int threads);
+};
+
+SpMV::Workspace::Workspace(int vertices) : size(vertices) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    marks = new unsigned char[vertices]();
+}
+
+SpMV::Workspace::~Workspace() {
+    delete[] marks;
+}
+
+template <typename S>
+long long SpMV::multiply(const CSRGraph& a, const typename S::Value* x, const int* active, long long activeCount,
+                         typename S::Value* y, Mask mask, int* changed, Workspace& ws,
+                         int threads, Direction direction, Direction* used) {
+    if (ws.size < a.getNumVertices())
+        throw "Workspace too small";
+    const long long* offsets = a.getOffsets();
+    if (direction == Auto) {
+        long long activeEdges = 0;
+        for (long long i = 0; i < activeCount; i++)
+            activeEdges += offsets[active[i] + 1] - offsets[active[i]];
+        direction = activeEdges * PullFactor < a.getNumEntries() ? Push : Pull;
+    }
+    if (used)
+        *used = direction;
+    if (direction == Push)
+        return pushRows<S>(a, x, active, activeCount, y, mask, changed, ws);
+    return pullRows<S>(a, x, y, mask, changed, ws, threads);
+}
+
+// pushRows: scatter each active entry along its row; O(edges of the active set).
+template <typename S>
+long long SpMV::pushRows(const CSRGraph& a, const typename S::Value* x, const int* active, long long activeCount,
+                         typename S::Value* y, Mask mask, int* changed, Workspace& ws) {
+    const long long* offsets = a.getOffsets();
+    const int* targets = a.getTargets();
+    const int* weights = a.getWeights();
+    long long numChanged = 0;
+    for (long long i = 0; i < activeCount; i++) {
+        int u = active[i];
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = targets[e];
+            if (!mask.allows(v))
+                continue;
+            typename S::Value sum = S::add(y[v], S::multiply(x[u], weights[e]));
+            if (sum != y[v]) {
+                y[v] = sum;
+                if (!ws.marks[v]) {
+                    ws.marks[v] = 1;
+                    changed[numChanged++] = v;
+                }
+            }
+        }
+    }
+    for (long long i = 0; i < numChanged; i++)
+        ws.marks[changed[i]] = 0;
+    return numChanged;
+}
+
+// pullRows: every allowed row reduces over its neighbours, rows in parallel;
+// a row stops early once its accumulator is terminal. Without terminal
+// states (Scan), the row is reduced into four accumulators that are
+// combined at the end, so floating-point sums are grouped by entry mod 4.
+template <typename S>
+long long SpMV::pullRows(const CSRGraph& a, const typename S::Value* x, typename S::Value* y,
+                         Mask mask, int* changed, Workspace& ws, int threads) {
+    const long long* offsets = a.getOffsets();
+    const int* targets = a.getTargets();
+    const int* weights = a.getWeights();
+    int n = a.getNumVertices();
+    Parallel::forDynamic(0, n, 1024, threads, [&](int, long long lo, long long hi) {
+        for (long long v = lo; v < hi; v++) {
+            if (!mask.allows(static_cast<int>(v)))
+                continue;
+            typename S::Value sum = y[v];
+            long long e = offsets[v], end = offsets[v + 1];
+            if (S::Scan) {
+                typename S::Value s0 = S::zero(), s1 = S::zero(), s2 = S::zero(), s3 = S::zero();
+                for (; e + 4 <= end; e += 4) {
+                    s0 = S::add(s0, S::multiply(x[targets[e]], weights[e]));
+                    s1 = S::add(s1, S::multiply(x[targets[e + 1]], weights[e + 1]));
+                    s2 = S::add(s2, S::multiply(x[targets[e + 2]], weights[e + 2]));
+                    s3 = S::add(s3, S::multiply(x[targets[e + 3]], weights[e + 3]));
+                }
+                for (; e < end; e++)
+                    s0 = S::add(s0, S::multiply(x[targets[e]], weights[e]));
+                sum = S::add(sum, S::add(S::add(s0, s1), S::add(s2, s3)));
+            } else {
+                for (; e < end && !S::terminal(sum); e++)
+                    sum = S::add(sum, S::multiply(x[targets[e]], weights[e]));
+            }
+            if (sum != y[v]) {
+                y[v] = sum;
+                ws.marks[v] = 1;
+            }
+        }
+    });
+    long long numChanged = 0;
+    for (int v = 0; v < n; v++) {
+        if (ws.marks[v]) {
+            ws.marks[v] = 0;
+            changed[numChanged++] = v;
+        }
+    }
+    return numChanged;
+}
+
+// bfsLevels: frontier = A * frontier under the complement of the visited mask.
+long long SpMV::bfsLevels(const CSRGraph& a, const int* sources, int count, int* level, int threads) {
+    int n = a.getNumVertices();
+    for (int i = 0; i < count; i++)
+        if (sources[i] < 0 || sources[i] >= n)
+            throw "Source vertex out of range";
+    unsigned char* frontierValues = new unsigned char[n]();
+    unsigned char* reachedValues = new unsigned char[n]();
+    bool* visited = new bool[n]();
+    int* frontier = new int[n];
+    int* next = new int[n];
+    long long frontierSize = 0;
+    for (int v = 0; v < n; v++)
+        level[v] = -1;
+    for (int i = 0; i < count; i++) {
+        int s = sources[i];
+        if (visited[s])
+            continue;
+        visited[s] = true;
+        frontierValues[s] = reachedValues[s] = 1;
+        level[s] = 0;
+        frontier[frontierSize++] = s;
+    }
+    long long total = frontierSize;
+    Workspace ws(n);
+    Mask unvisited = {visited, true};
+    for (int depth = 1; frontierSize > 0; depth++) {
+        long long nextSize = multiply<BooleanSemiring>(a, frontierValues, frontier, frontierSize,
+                                                       reachedValues, unvisited, next, ws, threads);
+        for (long long i = 0; i < frontierSize; i++)
+            frontierValues[frontier[i]] = 0;
+        for (long long i = 0; i < nextSize; i++) {
+            int v = next[i];
+            visited[v] = true;
+            frontierValues[v] = 1;
+            level[v] = depth;
+        }
+        int* swapTmp = frontier;
+        frontier = next;
+        next = swapTmp;
+        frontierSize = nextSize;
+        total += nextSize;
+    }
+    delete[] frontierValues;
+    delete[] reachedValues;
+    delete[] visited;
+    delete[] frontier;
+    delete[] next;
+    return total;
+}
+
+long long SpMV::bfsLevels(const CSRGraph& a, int source, int* level, int threads) {
+    return bfsLevels(a, &source, 1, level, threads);
+}
+
+long long SpMV::reachable(const CSRGraph& a, const int* sources, int count, bool* reached, int threads) {
+    int n = a.getNumVertices();
+    for (int i = 0; i < count; i++)
+        if (sources[i] < 0 || sources[i] >= n)
+            throw "Source vertex out of range";
+    int* level = new int[n];
+    long long total = bfsLevels(a, sources, count, level, threads);
+    for (int v = 0; v < n; v++)
+        reached[v] = level[v] >= 0;
+    delete[] level;
+    return total;
+}
+
+// sssp: dist = min(dist, A * x), where x holds the distances that changed last round.
+int SpMV::sssp(const CSRGraph& a, int source, long long* dist, int threads) {
+    int n = a.getNumVertices();
+    if (source < 0 || source >= n)
+        throw "Source vertex out of range";
+    for (long long e = 0; e < a.getNumEntries(); e++)
+        if (a.getWeights()[e] < 0)
+            throw "Negative edge weight";
+    typedef MinPlusSemiring::Value Value;
+    Value* x = new Value[n];
+    int* active = new int[n];
+    int* changed = new int[n];
+    for (int v = 0; v < n; v++)
+        x[v] = dist[v] = MinPlusSemiring::zero();
+    x[source] = dist[source] = 0;
+    active[0] = source;
+    long long activeCount = 1;
+    Workspace ws(n);
+    int rounds = 0;
+    while (activeCount > 0) {
+        long long numChanged = multiply<MinPlusSemiring>(a, x, active, activeCount, dist, all(), changed, ws, threads);
+        for (long long i = 0; i < activeCount; i++)
+            x[active[i]] = MinPlusSemiring::zero();
+        for (long long i = 0; i < numChanged; i++)
+            x[changed[i]] = dist[changed[i]];
+        int* swapTmp = active;
+        active = changed;
+        changed = swapTmp;
+        activeCount = numChanged;
+        rounds++;
+    }
+    delete[] x;
+    delete[] active;
+    delete[] changed;
+    return rounds;
+}
+
+} // namespace graph
+
+#endif // SPMV_CPP
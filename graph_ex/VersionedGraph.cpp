@@ -0,0 +1,708 @@
+// VersionedGraph.cpp
+#ifndef VERSIONEDGRAPH_CPP
+#define VERSIONEDGRAPH_CPP
+
+#include "Graph.cpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace graph {
+
+// Undirected weighted graph that can be read while it is being modified.
+// Each vertex's neighbours live in an immutable block. A writer copies only
+// the blocks (and block-table pages) it touches, then publishes the new
+// version with one atomic store. Readers pin an epoch, traverse a consistent
+// snapshot without locks, and old blocks are freed once no pinned reader
+// can still reach them.
+//
+// In tombstone mode a removal does not copy the block: it stamps the entry
+// with the version in which it died, and each snapshot skips entries that
+// died at or before its own version. Blocks whose dead fraction reaches the
+// compaction threshold are rewritten later by compact(), usually from the
+// background compactor thread.
+class VersionedGraph {
+private:
+    struct Block;
+    struct Page;
+    struct Version;
+
+public:
+    static const int PageSize = 1024;  // Vertices per block-table page.
+    static const int MaxReaders = 256; // Concurrently pinned snapshots.
+
+    // One change in a batch passed to apply().
+    struct Update {
+        int source;
+        int dest;
+        int weight;  // Ignored for removals.
+        bool remove;
+    };
+
+    // Pinned, immutable view of one version. Keep it short-lived: while it is
+    // alive, nothing replaced after its version can be reclaimed.
+    class Snapshot {
+    public:
+        explicit Snapshot(const VersionedGraph& g);
+        ~Snapshot();
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        unsigned long long version() const;
+        int getNumVertices() const;
+        int degree(int vertex) const;  // Live neighbours in this version.
+        // Raw block slots: entries(vertex) targets/weights, including any
+        // tombstoned entries (only possible in tombstone mode; see isLive).
+        int entries(int vertex) const;
+        const int* targets(int vertex) const;
+        const int* weights(int vertex) const;
+        bool isLive(int vertex, int entry) const;
+        Graph toGraph() const;
+
+    private:
+        const VersionedGraph& owner;
+        int slot;
+        const Version* ver;
+        const Block* block(int vertex) const;
+    };
+
+    explicit VersionedGraph(int vertices);
+    explicit VersionedGraph(const Graph& g);
+    ~VersionedGraph(); // Stops the compactor; no snapshot may outlive the graph.
+    VersionedGraph(const VersionedGraph&) = delete;
+    VersionedGraph& operator=(const VersionedGraph&) = delete;
+
+    // Writers are serialised; each call publishes exactly one new version.
+    void addEdge(int source, int dest, int weight = 1);
+    void removeEdge(int source, int dest);
+    // Applies all updates as one version; on error nothing is published.
+    void apply(const Update* updates, long long count);
+    // Frees retired blocks that no pinned snapshot can reach.
+    void reclaim();
+
+    // Tombstone mode and compaction.
+    void setTombstones(bool enabled, double compactThreshold = 0.25);
+    // Rewrites every queued block without its dead entries (one new version);
+    // returns the number of blocks rewritten.
+    int compact();
+    // Runs compact() on a background thread whenever blocks are queued.
+    void startCompactor();
+    void stopCompactor();
+    int pendingCompactions() const;
+
+    int getNumVertices() const;
+    unsigned long long currentVersion() const;
+    long long retiredCount() const; // Versions waiting for readers to move on.
+
+private:
+    static const unsigned long long Live = ~0ULL; // deadAt value of a live entry.
+
+    struct Block {
+        int degree; // Entries, including tombstones.
+        int* targets;
+        int* weights;
+        // Version in which each entry died (Live otherwise); allocated by the
+        // first tombstone, so blocks that never lose an edge pay nothing.
+        std::atomic<std::atomic<unsigned long long>*> deadAt;
+        std::atomic<int> deadCount;
+        Block(int d) : degree(d), targets(new int[d]), weights(new int[d]), deadAt(nullptr), deadCount(0) {}
+        ~Block() {
+            delete[] targets;
+            delete[] weights;
+            delete[] deadAt.load();
+        }
+        bool liveAt(int entry, unsigned long long version) const {
+            std::atomic<unsigned long long>* dead = deadAt.load(std::memory_order_acquire);
+            return !dead || dead[entry].load(std::memory_order_relaxed) > version;
+        }
+    };
+    struct Page {
+        Block* blocks[PageSize];
+    };
+    struct Version {
+        unsigned long long number;
+        Page** pages;
+    };
+    // Everything a publish replaced, freed once epoch <= every pinned epoch.
+    struct Retired {
+        unsigned long long epoch;
+        Version* version;
+        Page** pages;
+        int numPages;
+        Block** blocks;
+        int numBlocks;
+        Retired* next;
+    };
+    // Mutable copy of one vertex's list while a batch is being applied.
+    struct Work {
+        int vertex;
+        int degree;
+        int capacity;
+        int* targets;
+        int* weights;
+    };
+    // A tombstone written by the batch in progress (undone if the batch fails).
+    struct Mark {
+        int vertex;
+        Block* block;
+        int entry;
+    };
+
+    int numVertices;
+    int numPages;
+    std::atomic<Version*> current;
+    std::atomic<unsigned long long> epoch;
+    // Pinned epoch + 1 per reader slot, 0 when the slot is free.
+    mutable std::atomic<unsigned long long> readerEpochs[MaxReaders];
+    std::mutex writeLock;
+    Retired* retired;
+    std::atomic<long long> numRetired; // Written under writeLock; read lock-free by retiredCount.
+    int* workIndex;          // Writer scratch: vertex -> index in the batch's Work array.
+    unsigned int* pageStamp; // Writer scratch: page copied in the batch with this stamp.
+    unsigned int stampCounter;
+    bool tombstones;
+    double compactThreshold;
+    // Compaction queue; lock order is writeLock, then compactLock.
+    mutable std::mutex compactLock;
+    std::condition_variable compactSignal;
+    int* pending;
+    int numPending;
+    bool* queued;
+    bool compactorStop;
+    std::thread compactor;
+
+    void init(int vertices);
+    static void freeRetired(Retired* r);
+    void reclaimLocked();
+    Block* currentBlock(int vertex) const;
+    Work& touch(const Version* old, Work* work, int& numWork, int vertex);
+    void publishLocked(Version* old, Work* work, int numWork);
+    static bool markDead(Block* b, int target, unsigned long long version, Mark* marks, int& numMarks, int vertex);
+    static bool removeFrom(Work& w, int target);
+    static void append(Work& w, int target, int weight);
+};
+
+// --- Construction and destruction ---
+
+void VersionedGraph::init(int vertices) {
+    if (vertices <= 0)
+        throw "Number of vertices must be positive";
+    numVertices = vertices;
+    numPages = (vertices + PageSize - 1) / PageSize;
+    Version* v = new Version;
+    v->number = 0;
+    v->pages = new Page*[numPages];
+    for (int p = 0; p < numPages; p++) {
+        v->pages[p] = new Page;
+        for (int i = 0; i < PageSize; i++)
+            v->pages[p]->blocks[i] = 0;
+    }
+    current.store(v);
+    epoch.store(0);
+    for (int i = 0; i < MaxReaders; i++)
+        readerEpochs[i].store(0);
+    retired = 0;
+    numRetired.store(0);
+    workIndex = new int[numVertices];
+    for (int i = 0; i < numVertices; i++)
+        workIndex[i] = -1;
+    pageStamp = new unsigned int[numPages]();
+    stampCounter = 0;
+    tombstones = false;
+    compactThreshold = 0.25;
+    pending = new int[numVertices];
+    numPending = 0;
+    queued = new bool[numVertices]();
+    compactorStop = false;
+}
+
+VersionedGraph::VersionedGraph(int vertices) {
+    init(vertices);
+}
+
+VersionedGraph::VersionedGraph(const Graph& g) {
+    init(g.getNumVertices());
+    Version* v = current.load();
+    for (int u = 0; u < numVertices; u++) {
+        int d = g.getDegree(u);
+        if (d == 0)
+            continue;
+        Block* b = new Block(d);
+        int i = 0;
+        for (Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next, i++) {
+            b->targets[i] = e->destination;
+            b->weights[i] = e->weight;
+        }
+        v->pages[u / PageSize]->blocks[u % PageSize] = b;
+    }
+}
+
+void VersionedGraph::freeRetired(Retired* r) {
+    for (int i = 0; i < r->numBlocks; i++)
+        delete r->blocks[i];
+    for (int i = 0; i < r->numPages; i++)
+        delete r->pages[i];
+    delete[] r->blocks;
+    delete[] r->pages;
+    delete[] r->version->pages;
+    delete r->version;
+    delete r;
+}
+
+VersionedGraph::~VersionedGraph() {
+    stopCompactor();
+    while (retired) {
+        Retired* next = retired->next;
+        freeRetired(retired);
+        retired = next;
+    }
+    Version* v = current.load();
+    for (int p = 0; p < numPages; p++) {
+        for (int i = 0; i < PageSize; i++)
+            delete v->pages[p]->blocks[i];
+        delete v->pages[p];
+    }
+    delete[] v->pages;
+    delete v;
+    delete[] workIndex;
+    delete[] pageStamp;
+    delete[] pending;
+    delete[] queued;
+}
+
+// --- Writers ---
+
+void VersionedGraph::addEdge(int source, int dest, int weight) {
+    Update u = {source, dest, weight, false};
+    apply(&u, 1);
+}
+
+void VersionedGraph::removeEdge(int source, int dest) {
+    Update u = {source, dest, 0, true};
+    apply(&u, 1);
+}
+
+bool VersionedGraph::removeFrom(Work& w, int target) {
+    for (int i = 0; i < w.degree; i++) {
+        if (w.targets[i] == target) {
+            for (int j = i + 1; j < w.degree; j++) {
+                w.targets[j - 1] = w.targets[j];
+                w.weights[j - 1] = w.weights[j];
+            }
+            w.degree--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void VersionedGraph::append(Work& w, int target, int weight) {
+    if (w.degree == w.capacity) {
+        int capacity = w.capacity < 4 ? 8 : w.capacity * 2;
+        int* t = new int[capacity];
+        int* wt = new int[capacity];
+        for (int i = 0; i < w.degree; i++) {
+            t[i] = w.targets[i];
+            wt[i] = w.weights[i];
+        }
+        delete[] w.targets;
+        delete[] w.weights;
+        w.targets = t;
+        w.weights = wt;
+        w.capacity = capacity;
+    }
+    w.targets[w.degree] = target;
+    w.weights[w.degree] = weight;
+    w.degree++;
+}
+
+VersionedGraph::Block* VersionedGraph::currentBlock(int vertex) const {
+    return current.load()->pages[vertex / PageSize]->blocks[vertex % PageSize];
+}
+
+// touch: the batch's mutable copy of a vertex's list, made on first use.
+// Tombstoned entries (including ones marked earlier in this batch) are dropped.
+VersionedGraph::Work& VersionedGraph::touch(const Version* old, Work* work, int& numWork, int vertex) {
+    if (workIndex[vertex] < 0) {
+        const Block* b = old->pages[vertex / PageSize]->blocks[vertex % PageSize];
+        Work& w = work[numWork];
+        w.vertex = vertex;
+        w.degree = 0;
+        w.capacity = b ? b->degree : 0;
+        w.targets = new int[w.capacity];
+        w.weights = new int[w.capacity];
+        std::atomic<unsigned long long>* dead = b ? b->deadAt.load() : nullptr;
+        for (int i = 0; i < w.capacity; i++) {
+            if (dead && dead[i].load() != Live)
+                continue;
+            w.targets[w.degree] = b->targets[i];
+            w.weights[w.degree] = b->weights[i];
+            w.degree++;
+        }
+        workIndex[vertex] = numWork++;
+    }
+    return work[workIndex[vertex]];
+}
+
+// markDead: stamp the first live entry to 'target' with the dying version.
+bool VersionedGraph::markDead(Block* b, int target, unsigned long long version, Mark* marks, int& numMarks, int vertex) {
+    if (!b)
+        return false;
+    std::atomic<unsigned long long>* dead = b->deadAt.load();
+    for (int i = 0; i < b->degree; i++) {
+        if (b->targets[i] != target || (dead && dead[i].load() != Live))
+            continue;
+        if (!dead) {
+            dead = new std::atomic<unsigned long long>[b->degree];
+            for (int j = 0; j < b->degree; j++)
+                dead[j].store(Live, std::memory_order_relaxed);
+            b->deadAt.store(dead, std::memory_order_release);
+        }
+        dead[i].store(version, std::memory_order_relaxed);
+        b->deadCount++;
+        Mark m = {vertex, b, i};
+        marks[numMarks++] = m;
+        return true;
+    }
+    return false;
+}
+
+void VersionedGraph::apply(const Update* updates, long long count) {
+    for (long long i = 0; i < count; i++)
+        if (updates[i].source < 0 || updates[i].source >= numVertices ||
+            updates[i].dest < 0 || updates[i].dest >= numVertices)
+            throw "Vertex index out of range";
+    if (count <= 0)
+        return;
+    std::lock_guard<std::mutex> lock(writeLock);
+    Version* old = current.load();
+    unsigned long long nextNumber = old->number + 1;
+
+    // Copy each touched vertex's list once, then apply the updates in order.
+    // In tombstone mode, removals on untouched vertices only mark the entry.
+    long long maxTouched = 2 * count < numVertices ? 2 * count : numVertices;
+    Work* work = new Work[maxTouched];
+    int numWork = 0;
+    Mark* marks = tombstones ? new Mark[2 * count] : 0;
+    int numMarks = 0;
+    auto removeDirected = [&](int from, int to) -> bool {
+        if (tombstones && workIndex[from] < 0)
+            return markDead(old->pages[from / PageSize]->blocks[from % PageSize], to, nextNumber, marks, numMarks, from);
+        return removeFrom(touch(old, work, numWork, from), to);
+    };
+    bool missingEdge = false;
+    for (long long i = 0; i < count && !missingEdge; i++) {
+        const Update& up = updates[i];
+        if (up.remove) {
+            bool forward = removeDirected(up.source, up.dest);
+            bool reverse = removeDirected(up.dest, up.source);
+            missingEdge = !forward && !reverse;
+        } else {
+            append(touch(old, work, numWork, up.source), up.dest, up.weight);
+            append(touch(old, work, numWork, up.dest), up.source, up.weight);
+        }
+    }
+    if (missingEdge) {
+        // No reader can see nextNumber yet, so clearing the marks is safe.
+        for (int i = 0; i < numMarks; i++) {
+            marks[i].block->deadAt.load()[marks[i].entry].store(Live);
+            marks[i].block->deadCount--;
+        }
+        for (int i = 0; i < numWork; i++) {
+            workIndex[work[i].vertex] = -1;
+            delete[] work[i].targets;
+            delete[] work[i].weights;
+        }
+        delete[] work;
+        delete[] marks;
+        throw "Edge does not exist";
+    }
+    publishLocked(old, work, numWork);
+
+    // Queue blocks that crossed the dead-fraction threshold.
+    if (numMarks > 0) {
+        bool signal = false;
+        {
+            std::lock_guard<std::mutex> queueLock(compactLock);
+            for (int i = 0; i < numMarks; i++) {
+                const Block* b = marks[i].block;
+                int v = marks[i].vertex;
+                if (!queued[v] && b->deadCount.load() >= compactThreshold * b->degree) {
+                    queued[v] = true;
+                    pending[numPending++] = v;
+                    signal = true;
+                }
+            }
+        }
+        if (signal)
+            compactSignal.notify_one();
+    }
+    delete[] marks;
+}
+
+// publishLocked: path-copy the touched pages into a new version, publish it,
+// and retire what it replaced. Consumes 'work'.
+void VersionedGraph::publishLocked(Version* old, Work* work, int numWork) {
+    Version* next = new Version;
+    next->number = old->number + 1;
+    next->pages = new Page*[numPages];
+    for (int p = 0; p < numPages; p++)
+        next->pages[p] = old->pages[p];
+    Retired* r = new Retired;
+    r->epoch = next->number;
+    r->version = old;
+    r->pages = new Page*[numWork < numPages ? numWork : numPages];
+    r->numPages = 0;
+    r->blocks = new Block*[numWork];
+    r->numBlocks = 0;
+    stampCounter++;
+    for (int i = 0; i < numWork; i++) {
+        Work& w = work[i];
+        int p = w.vertex / PageSize;
+        if (pageStamp[p] != stampCounter) {
+            pageStamp[p] = stampCounter;
+            r->pages[r->numPages++] = old->pages[p];
+            Page* copy = new Page(*old->pages[p]);
+            next->pages[p] = copy;
+        }
+        Block*& slot = next->pages[p]->blocks[w.vertex % PageSize];
+        if (slot)
+            r->blocks[r->numBlocks++] = slot;
+        slot = 0;
+        if (w.degree > 0) {
+            Block* b = new Block(w.degree);
+            for (int j = 0; j < w.degree; j++) {
+                b->targets[j] = w.targets[j];
+                b->weights[j] = w.weights[j];
+            }
+            slot = b;
+        }
+        workIndex[w.vertex] = -1;
+        delete[] w.targets;
+        delete[] w.weights;
+    }
+    delete[] work;
+
+    // Publish, then advance the epoch; readers that pin from now on see 'next'.
+    current.store(next);
+    epoch.store(next->number);
+    r->next = retired;
+    retired = r;
+    numRetired++;
+    reclaimLocked();
+}
+
+void VersionedGraph::reclaim() {
+    std::lock_guard<std::mutex> lock(writeLock);
+    reclaimLocked();
+}
+
+void VersionedGraph::reclaimLocked() {
+    unsigned long long minPinned = ~0ULL;
+    for (int i = 0; i < MaxReaders; i++) {
+        unsigned long long e = readerEpochs[i].load();
+        if (e != 0 && e - 1 < minPinned)
+            minPinned = e - 1;
+    }
+    Retired** link = &retired;
+    while (*link) {
+        Retired* r = *link;
+        if (r->epoch <= minPinned) {
+            *link = r->next;
+            freeRetired(r);
+            numRetired--;
+        } else {
+            link = &r->next;
+        }
+    }
+}
+
+// --- Tombstones and compaction ---
+
+void VersionedGraph::setTombstones(bool enabled, double threshold) {
+    if (!(threshold > 0) || threshold > 1)
+        throw "Compaction threshold must be in (0, 1]";
+    std::lock_guard<std::mutex> lock(writeLock);
+    tombstones = enabled;
+    compactThreshold = threshold;
+}
+
+int VersionedGraph::compact() {
+    std::lock_guard<std::mutex> lock(writeLock);
+    int* vertices;
+    int count;
+    {
+        std::lock_guard<std::mutex> queueLock(compactLock);
+        count = numPending;
+        vertices = new int[count];
+        for (int i = 0; i < count; i++) {
+            vertices[i] = pending[i];
+            queued[pending[i]] = false;
+        }
+        numPending = 0;
+    }
+    Version* old = current.load();
+    Work* work = new Work[count > 0 ? count : 1];
+    int numWork = 0;
+    for (int i = 0; i < count; i++) {
+        const Block* b = currentBlock(vertices[i]);
+        if (b && b->deadCount.load() > 0)
+            touch(old, work, numWork, vertices[i]);
+    }
+    delete[] vertices;
+    if (numWork == 0) {
+        delete[] work;
+        return 0;
+    }
+    publishLocked(old, work, numWork);
+    return numWork;
+}
+
+void VersionedGraph::startCompactor() {
+    std::lock_guard<std::mutex> queueLock(compactLock);
+    if (compactor.joinable())
+        return;
+    compactorStop = false;
+    compactor = std::thread([this]() {
+        std::unique_lock<std::mutex> wait(compactLock);
+        while (true) {
+            compactSignal.wait(wait, [this]() { return compactorStop || numPending > 0; });
+            if (compactorStop)
+                break;
+            wait.unlock();
+            compact();
+            wait.lock();
+        }
+    });
+}
+
+void VersionedGraph::stopCompactor() {
+    {
+        std::lock_guard<std::mutex> queueLock(compactLock);
+        if (!compactor.joinable())
+            return;
+        compactorStop = true;
+    }
+    compactSignal.notify_one();
+    compactor.join();
+}
+
+int VersionedGraph::pendingCompactions() const {
+    std::lock_guard<std::mutex> queueLock(compactLock);
+    return numPending;
+}
+
+int VersionedGraph::getNumVertices() const {
+    return numVertices;
+}
+
+unsigned long long VersionedGraph::currentVersion() const {
+    return current.load()->number;
+}
+
+long long VersionedGraph::retiredCount() const {
+    return numRetired.load();
+}
+
+// --- Readers ---
+
+// Pin: claim a slot holding the current epoch, then load the version.
+// A writer that misses the slot has already published a newer version,
+// so the load below cannot return anything it is about to free.
+VersionedGraph::Snapshot::Snapshot(const VersionedGraph& g) : owner(g), slot(-1), ver(0) {
+    for (int i = 0; i < MaxReaders && slot < 0; i++) {
+        unsigned long long expected = 0;
+        if (g.readerEpochs[i].compare_exchange_strong(expected, g.epoch.load() + 1))
+            slot = i;
+    }
+    if (slot < 0)
+        throw "Too many concurrent snapshots";
+    ver = g.current.load();
+}
+
+VersionedGraph::Snapshot::~Snapshot() {
+    owner.readerEpochs[slot].store(0);
+}
+
+const VersionedGraph::Block* VersionedGraph::Snapshot::block(int vertex) const {
+    if (vertex < 0 || vertex >= owner.numVertices)
+        throw "Vertex index out of range";
+    return ver->pages[vertex / PageSize]->blocks[vertex % PageSize];
+}
+
+unsigned long long VersionedGraph::Snapshot::version() const {
+    return ver->number;
+}
+
+int VersionedGraph::Snapshot::getNumVertices() const {
+    return owner.numVertices;
+}
+
+int VersionedGraph::Snapshot::degree(int vertex) const {
+    const Block* b = block(vertex);
+    if (!b)
+        return 0;
+    if (b->deadCount.load() == 0)
+        return b->degree;
+    int live = 0;
+    for (int i = 0; i < b->degree; i++)
+        if (b->liveAt(i, ver->number))
+            live++;
+    return live;
+}
+
+int VersionedGraph::Snapshot::entries(int vertex) const {
+    const Block* b = block(vertex);
+    return b ? b->degree : 0;
+}
+
+const int* VersionedGraph::Snapshot::targets(int vertex) const {
+    const Block* b = block(vertex);
+    return b ? b->targets : 0;
+}
+
+const int* VersionedGraph::Snapshot::weights(int vertex) const {
+    const Block* b = block(vertex);
+    return b ? b->weights : 0;
+}
+
+bool VersionedGraph::Snapshot::isLive(int vertex, int entry) const {
+    const Block* b = block(vertex);
+    if (!b || entry < 0 || entry >= b->degree)
+        throw "Entry index out of range";
+    return b->liveAt(entry, ver->number);
+}
+
+// toGraph: materialise the snapshot so the Algorithms routines can run on it.
+Graph VersionedGraph::Snapshot::toGraph() const {
+    int n = owner.numVertices;
+    long long entryCount = 0;
+    for (int u = 0; u < n; u++)
+        entryCount += entries(u);
+    Graph g(n);
+    Graph::EdgeTriple* batch = new Graph::EdgeTriple[entryCount / 2 + 1];
+    long long count = 0;
+    for (int u = 0; u < n; u++) {
+        const Block* b = block(u);
+        bool skipLoop = false;
+        for (int i = 0; b && i < b->degree; i++) {
+            if (!b->liveAt(i, ver->number))
+                continue;
+            int v = b->targets[i];
+            if (u < v || (u == v && !skipLoop)) {
+                Graph::EdgeTriple e = {u, v, b->weights[i]};
+                batch[count++] = e;
+            }
+            if (u == v)
+                skipLoop = !skipLoop;
+        }
+    }
+    g.addEdges(batch, count);
+    delete[] batch;
+    return g;
+}
+
+} // namespace graph
+
+#endif // VERSIONEDGRAPH_CPP
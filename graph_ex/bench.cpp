@@ -0,0 +1,610 @@
+// bench.cpp
+// Benchmark harness: runs graph routines over generated or file-loaded graphs
+// and writes one JSON or CSV record per (graph, algorithm) pair.
+//
+// Usage: ./bench [--graph SPEC]... [--algo a,b,...] [--reps N] [--threads N]
+//                [--seed N] [--max-weight N] [--format json|csv] [--out PATH]
+// Graph specs:
+//   kron:SCALE:EDGEFACTOR        Graph500 Kronecker
+//   rmat:SCALE:EDGEFACTOR:A:B:C  R-MAT
+//   grid:ROWS:COLS[:DROP]        2D lattice (road-like when DROP > 0)
+//   er:VERTICES:EDGES            Erdos-Renyi G(n, m)
+//   rgg:VERTICES:RADIUS          Random geometric graph
+//   file:PATH                    Edge list, one "u v [w]" per line ('#' / '%' comments)
+#include "Algorithms.cpp"
+#include "Centrality.cpp"
+#include "Coloring.cpp"
+#include "Communities.cpp"
+#include "Connectivity.cpp"
+#include "Cores.cpp"
+#include "DenseGraph.cpp"
+#include "Distances.cpp"
+#include "Flow.cpp"
+#include "Generators.cpp"
+#include "Matching.cpp"
+#include "Paths.cpp"
+#include "SpMV.cpp"
+#include "Triangles.cpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+// --- Allocation counting ---
+static std::atomic<long long> allocCount(0);
+static std::atomic<long long> allocBytes(0);
+
+static void* countedAlloc(std::size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+// --- Peak RSS ---
+// Resets the kernel's high-water mark so each case measures its own peak;
+// returns false where that is not possible.
+static bool resetPeakRss() {
+    std::ofstream out("/proc/self/clear_refs");
+    if (!out)
+        return false;
+    out << "5";
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+// A "Vm...:" field of /proc/self/status in kB, or -1 if it is missing.
+static long long statusKb(const char* field) {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    size_t length = std::strlen(field);
+    while (std::getline(in, line))
+        if (line.compare(0, length, field) == 0)
+            return std::atoll(line.c_str() + length);
+    return -1;
+}
+
+// --- Output escaping ---
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+// Quotes a CSV field (RFC 4180) when it holds a comma, quote or line break.
+static std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"\r\n") == std::string::npos)
+        return text;
+    std::string out = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"')
+            out += '"';
+        out += text[i];
+    }
+    return out + "\"";
+}
+
+// --- Benchmark inputs ---
+struct BenchInput {
+    const graph::Graph* g;
+    const graph::CSRGraph* csr;
+    const graph::DenseGraph* dense; // Null unless DenseGraph::preferred.
+    int source;
+    int threads;
+};
+
+struct BenchCase {
+    const char* name;
+    void (*run)(const BenchInput& in);
+    bool dense; // Runs only on graphs dense enough for DenseGraph.
+};
+
+static void runBfs(const BenchInput& in) { graph::Algorithms::bfs(*in.g, in.source); }
+static void runDfs(const BenchInput& in) { graph::Algorithms::dfs(*in.g, in.source); }
+static void runDijkstra(const BenchInput& in) { graph::Algorithms::dijkstra(*in.g, in.source); }
+static void runPrim(const BenchInput& in) { graph::Algorithms::prim(*in.g); }
+static void runKruskal(const BenchInput& in) { graph::Algorithms::kruskal(*in.g); }
+static void runCsrBuild(const BenchInput& in) { graph::CSRGraph::fromGraph(*in.g, in.threads); }
+static void runBulkIngest(const BenchInput& in) { in.csr->toGraph(); }
+static void runSpmvBfs(const BenchInput& in) {
+    int* level = new int[in.csr->getNumVertices()];
+    graph::SpMV::bfsLevels(*in.csr, in.source, level, in.threads);
+    delete[] level;
+}
+static void runSpmvSssp(const BenchInput& in) {
+    long long* dist = new long long[in.csr->getNumVertices()];
+    graph::SpMV::sssp(*in.csr, in.source, dist, in.threads);
+    delete[] dist;
+}
+static void runPageRank(const BenchInput& in) {
+    double* rank = new double[in.csr->getNumVertices()];
+    graph::Centrality::pageRank(*in.csr, rank, 0.85, 1e-9, 100, in.threads);
+    delete[] rank;
+}
+// Sampled: exact betweenness runs one search per vertex.
+static void runBetweenness(const BenchInput& in) {
+    double* score = new double[in.csr->getNumVertices()];
+    graph::Centrality::betweennessSampled(*in.csr, 64, score, 1, 0.95, false, in.threads);
+    delete[] score;
+}
+static void runLouvain(const BenchInput& in) {
+    int* community = new int[in.csr->getNumVertices()];
+    graph::Communities::louvain(*in.csr, community, 1.0, in.threads);
+    delete[] community;
+}
+static void runLabelPropagation(const BenchInput& in) {
+    int* community = new int[in.csr->getNumVertices()];
+    graph::Communities::labelPropagation(*in.csr, community, 20, 1, in.threads);
+    delete[] community;
+}
+// Source to the highest-degree other vertex, network conversion included.
+static void runMaxFlow(const BenchInput& in) {
+    int sink = in.source == 0 ? 1 : 0;
+    for (int v = 0; v < in.csr->getNumVertices(); v++)
+        if (v != in.source && in.csr->degree(v) > in.csr->degree(sink))
+            sink = v;
+    graph::FlowNetwork net = graph::FlowNetwork::fromGraph(*in.g);
+    if (in.threads == 1)
+        graph::MaxFlow::solve(net, in.source, sink);
+    else
+        graph::MaxFlow::solveParallel(net, in.source, sink, 0, in.threads);
+}
+// On the bipartite double cover (u, v) -> (u, n + v), (v, n + u); building it is included.
+static void runMatching(const BenchInput& in) {
+    int n = in.csr->getNumVertices();
+    long long count = 0;
+    int* src = new int[in.csr->getNumEntries() + 1];
+    int* dst = new int[in.csr->getNumEntries() + 1];
+    for (int u = 0; u < n; u++)
+        for (long long e = in.csr->getOffsets()[u]; e < in.csr->getOffsets()[u + 1]; e++) {
+            src[count] = u;
+            dst[count++] = n + in.csr->getTargets()[e];
+        }
+    graph::CSRGraph cover = graph::CSRGraph::fromEdges(2 * n, src, dst, 0, count, in.threads);
+    delete[] src;
+    delete[] dst;
+    bool* left = new bool[2 * n];
+    int* mate = new int[2 * n];
+    for (int v = 0; v < 2 * n; v++)
+        left[v] = v < n;
+    graph::Matching::hopcroftKarp(cover, mate, left, in.threads);
+    delete[] left;
+    delete[] mate;
+}
+static void runColoring(const BenchInput& in) {
+    int* color = new int[in.csr->getNumVertices()];
+    graph::Coloring::speculative(*in.csr, color, graph::Coloring::Natural, in.threads);
+    delete[] color;
+}
+static void runColoringJp(const BenchInput& in) {
+    int* color = new int[in.csr->getNumVertices()];
+    graph::Coloring::jonesPlassmann(*in.csr, color, graph::Coloring::Natural, 1, in.threads);
+    delete[] color;
+}
+static void runScc(const BenchInput& in) {
+    // Orient each edge by the parity of its endpoints, so cycles and a DAG fringe mix.
+    const graph::CSRGraph& g = *in.csr;
+    int n = g.getNumVertices();
+    const long long* offsets = g.getOffsets();
+    const int* targets = g.getTargets();
+    int* src = new int[g.getNumEntries() / 2 + 1];
+    int* dst = new int[g.getNumEntries() / 2 + 1];
+    long long count = 0;
+    for (int u = 0; u < n; u++)
+        for (long long e = offsets[u]; e < offsets[u + 1]; e++)
+            if (u < targets[e]) {
+                bool forward = ((u + targets[e]) & 1) == 0;
+                src[count] = forward ? u : targets[e];
+                dst[count++] = forward ? targets[e] : u;
+            }
+    int* component = new int[n];
+    graph::Connectivity::stronglyConnected(n, src, dst, count, component, true, in.threads);
+    delete[] src;
+    delete[] dst;
+    delete[] component;
+}
+static void runBiconnected(const BenchInput& in) {
+    int* component = new int[in.csr->getNumEntries()];
+    graph::Connectivity::biconnectedComponents(*in.csr, component);
+    delete[] component;
+}
+// Five routes from the source to the highest-numbered vertex with an edge.
+static void runKShortest(const BenchInput& in) {
+    int target = in.csr->getNumVertices() - 1;
+    while (target > 0 && in.csr->degree(target) == 0)
+        target--;
+    graph::Paths::kShortest(*in.csr, in.source, target, 5, in.threads);
+}
+// 64 x 64 table over vertices spread evenly through the id range.
+static void runDistanceTable(const BenchInput& in) {
+    const int count = 64;
+    int n = in.csr->getNumVertices();
+    int ids[count];
+    for (int i = 0; i < count; i++)
+        ids[i] = static_cast<int>(static_cast<long long>(i) * n / count);
+    long long* table = new long long[count * count];
+    graph::Paths::distanceTable(*in.csr, ids, count, ids, count, table, in.threads);
+    delete[] table;
+}
+static void runDiameter(const BenchInput& in) { graph::Distances::diameter(*in.csr, 0, 64, in.threads); }
+static void runHyperAnf(const BenchInput& in) {
+    double nf[65];
+    graph::Distances::neighbourhoodFunction(*in.csr, nf, 64, 6, 1, in.threads);
+}
+static void runTriangles(const BenchInput& in) { graph::Triangles::count(*in.csr, 0, in.threads); }
+static void runKCore(const BenchInput& in) {
+    int* core = new int[in.csr->getNumVertices()];
+    graph::Cores::coreNumbers(*in.csr, core, in.threads);
+    delete[] core;
+}
+static void runDenseBfs(const BenchInput& in) { in.dense->bfs(in.source); }
+static void runDensePrim(const BenchInput& in) { in.dense->prim(); }
+
+static const BenchCase benchCases[] = {
+    {"bfs", runBfs, false},
+    {"dfs", runDfs, false},
+    {"dijkstra", runDijkstra, false},
+    {"prim", runPrim, false},
+    {"kruskal", runKruskal, false},
+    {"csr_build", runCsrBuild, false},
+    {"bulk_ingest", runBulkIngest, false},
+    {"spmv_bfs", runSpmvBfs, false},
+    {"spmv_sssp", runSpmvSssp, false},
+    {"pagerank", runPageRank, false},
+    {"betweenness", runBetweenness, false},
+    {"louvain", runLouvain, false},
+    {"label_propagation", runLabelPropagation, false},
+    {"max_flow", runMaxFlow, false},
+    {"matching", runMatching, false},
+    {"coloring", runColoring, false},
+    {"coloring_jp", runColoringJp, false},
+    {"scc", runScc, false},
+    {"biconnected", runBiconnected, false},
+    {"k_shortest", runKShortest, false},
+    {"distance_table", runDistanceTable, false},
+    {"diameter", runDiameter, false},
+    {"hyperanf", runHyperAnf, false},
+    {"triangles", runTriangles, false},
+    {"kcore", runKCore, false},
+    {"dense_bfs", runDenseBfs, true},
+    {"dense_prim", runDensePrim, true},
+};
+static const int numBenchCases = sizeof(benchCases) / sizeof(benchCases[0]);
+
+// --- Graph loading ---
+// Growable edge arrays for loadEdgeList; the destructor frees them if parsing throws.
+struct EdgeBuffer {
+    long long capacity, count;
+    int* src;
+    int* dst;
+    int* w;
+
+    EdgeBuffer() : capacity(1024), count(0), src(new int[1024]), dst(new int[1024]), w(new int[1024]) {}
+    ~EdgeBuffer() {
+        delete[] src;
+        delete[] dst;
+        delete[] w;
+    }
+
+    void push(int u, int v, int weight) {
+        if (count == capacity) {
+            long long grown = capacity * 2;
+            int* ns = new int[grown];
+            int* nd = new int[grown];
+            int* nw = new int[grown];
+            std::memcpy(ns, src, count * sizeof(int));
+            std::memcpy(nd, dst, count * sizeof(int));
+            std::memcpy(nw, w, count * sizeof(int));
+            delete[] src;
+            delete[] dst;
+            delete[] w;
+            src = ns;
+            dst = nd;
+            w = nw;
+            capacity = grown;
+        }
+        src[count] = u;
+        dst[count] = v;
+        w[count] = weight;
+        count++;
+    }
+
+private:
+    EdgeBuffer(const EdgeBuffer&);
+    EdgeBuffer& operator=(const EdgeBuffer&);
+};
+
+static graph::CSRGraph loadEdgeList(const std::string& path, int maxWeight, int threads) {
+    std::ifstream in(path.c_str());
+    if (!in)
+        throw "Cannot open edge list file";
+    EdgeBuffer edges;
+    int maxId = -1;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#' || line[0] == '%')
+            continue;
+        std::istringstream fields(line);
+        long long u, v, weight = 1;
+        if (!(fields >> u >> v))
+            continue;
+        if (!(fields >> weight))
+            weight = 1;
+        if (u < 0 || v < 0 || u > 2147483646LL || v > 2147483646LL)
+            throw "Vertex index out of range";
+        if (weight > maxWeight)
+            weight = maxWeight;
+        edges.push(static_cast<int>(u), static_cast<int>(v), static_cast<int>(weight));
+        if (u > maxId) maxId = static_cast<int>(u);
+        if (v > maxId) maxId = static_cast<int>(v);
+    }
+    if (maxId < 0)
+        throw "Edge list file is empty";
+    return graph::CSRGraph::fromEdges(maxId + 1, edges.src, edges.dst, edges.w, edges.count, threads);
+}
+
+// Splits "kind:a:b:..." into its fields.
+static int splitSpec(const std::string& spec, std::string* fields, int maxFields) {
+    int n = 0;
+    std::string::size_type start = 0;
+    while (n < maxFields) {
+        std::string::size_type colon = spec.find(':', start);
+        if (colon == std::string::npos || n == maxFields - 1) {
+            fields[n++] = spec.substr(start);
+            break;
+        }
+        fields[n++] = spec.substr(start, colon - start);
+        start = colon + 1;
+    }
+    return n;
+}
+
+static graph::CSRGraph makeGraph(const std::string& spec, unsigned long long seed, int maxWeight, int threads) {
+    std::string f[6];
+    int n = splitSpec(spec, f, 6);
+    if (f[0] == "kron" && n == 3)
+        return graph::Generators::kronecker(std::atoi(f[1].c_str()), std::atoi(f[2].c_str()), seed, maxWeight, threads);
+    if (f[0] == "rmat" && n == 6)
+        return graph::Generators::rmat(std::atoi(f[1].c_str()), std::atoi(f[2].c_str()), std::atof(f[3].c_str()),
+                                       std::atof(f[4].c_str()), std::atof(f[5].c_str()), seed, maxWeight, threads);
+    if (f[0] == "grid" && (n == 3 || n == 4))
+        return graph::Generators::grid(std::atoi(f[1].c_str()), std::atoi(f[2].c_str()),
+                                       n == 4 ? std::atof(f[3].c_str()) : 0.0, seed, maxWeight, threads);
+    if (f[0] == "er" && n == 3)
+        return graph::Generators::erdosRenyi(std::atoi(f[1].c_str()), std::atoll(f[2].c_str()), seed, maxWeight, threads);
+    if (f[0] == "rgg" && n == 3)
+        return graph::Generators::randomGeometric(std::atoi(f[1].c_str()), std::atof(f[2].c_str()), seed, maxWeight, threads);
+    if (f[0] == "file" && n >= 2)
+        return loadEdgeList(spec.substr(5), maxWeight, threads);
+    throw "Unknown graph specification";
+}
+
+// --- Results ---
+struct BenchResult {
+    std::string graphSpec;
+    std::string algorithm;
+    int vertices;
+    long long edges;
+    int reps;
+    double minMs, medianMs, meanMs;
+    double teps; // Edges per second at the median time.
+    long long peakRssGrowthKb; // Peak RSS during the case minus RSS before it; -1 if unmeasurable.
+    long long allocations;
+    long long allocatedBytes;
+    graph::CallStats stats; // Filled from the first rep in instrumented builds.
+};
+
+static void writeJson(std::ostream& out, const BenchResult* results, int count, int threads) {
+    out << "{\n  \"version\": 1,\n  \"threads\": " << threads << ",\n  \"results\": [";
+    for (int i = 0; i < count; i++) {
+        const BenchResult& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"graph\": " << jsonString(r.graphSpec) << ", \"algorithm\": \"" << r.algorithm
+            << "\", \"vertices\": " << r.vertices << ", \"edges\": " << r.edges << ", \"reps\": " << r.reps
+            << ", \"min_ms\": " << r.minMs << ", \"median_ms\": " << r.medianMs << ", \"mean_ms\": " << r.meanMs
+            << ", \"teps\": " << r.teps << ", \"peak_rss_growth_kb\": " << r.peakRssGrowthKb
+            << ", \"allocations\": " << r.allocations << ", \"allocated_bytes\": " << r.allocatedBytes;
+        if (graph::Instrumentation::enabled()) {
+            const graph::CallStats& s = r.stats;
+            out << ", \"counters\": {\"hardware\": " << (s.hardwareCounters ? "true" : "false")
+                << ", \"cycles\": " << s.cycles << ", \"instructions\": " << s.instructions
+                << ", \"llc_misses\": " << s.llcMisses << ", \"branch_misses\": " << s.branchMisses
+                << ", \"edges_scanned\": " << s.edgesScanned << ", \"heap_pushes\": " << s.heapPushes
+                << ", \"heap_pops\": " << s.heapPops << ", \"decrease_keys\": " << s.decreaseKeys
+                << ", \"union_find_ops\": " << s.unionFindOps << ", \"levels\": " << s.levels << "}";
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static void writeCsv(std::ostream& out, const BenchResult* results, int count, int threads) {
+    bool counters = graph::Instrumentation::enabled();
+    out << "graph,algorithm,threads,vertices,edges,reps,min_ms,median_ms,mean_ms,teps,peak_rss_growth_kb,allocations,allocated_bytes";
+    if (counters)
+        out << ",cycles,instructions,llc_misses,branch_misses,edges_scanned,heap_pushes,heap_pops,decrease_keys,union_find_ops,levels";
+    out << "\n";
+    for (int i = 0; i < count; i++) {
+        const BenchResult& r = results[i];
+        out << csvField(r.graphSpec) << "," << r.algorithm << "," << threads << "," << r.vertices << "," << r.edges << ","
+            << r.reps << "," << r.minMs << "," << r.medianMs << "," << r.meanMs << "," << r.teps << ","
+            << r.peakRssGrowthKb << "," << r.allocations << "," << r.allocatedBytes;
+        if (counters) {
+            const graph::CallStats& s = r.stats;
+            out << "," << s.cycles << "," << s.instructions << "," << s.llcMisses << "," << s.branchMisses << ","
+                << s.edgesScanned << "," << s.heapPushes << "," << s.heapPops << "," << s.decreaseKeys << ","
+                << s.unionFindOps << "," << s.levels;
+        }
+        out << "\n";
+    }
+}
+
+static BenchResult runCase(const BenchCase& bc, const BenchInput& in, const std::string& spec, long long edges, int reps) {
+    BenchResult r;
+    r.graphSpec = spec;
+    r.algorithm = bc.name;
+    r.vertices = in.g->getNumVertices();
+    r.edges = edges;
+    r.reps = reps;
+    double* times = new double[reps];
+    bool resetRss = resetPeakRss();
+    long long rssBefore = statusKb("VmRSS:");
+    for (int i = 0; i < reps; i++) {
+        long long countBefore = allocCount.load(), bytesBefore = allocBytes.load();
+        graph::Instrumentation::clearLastCall();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bc.run(in);
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        times[i] = std::chrono::duration<double, std::milli>(stop - start).count();
+        if (i == 0) {
+            r.allocations = allocCount.load() - countBefore;
+            r.allocatedBytes = allocBytes.load() - bytesBefore;
+            r.stats = graph::Instrumentation::lastCall();
+        }
+    }
+    long long peak = statusKb("VmHWM:");
+    r.peakRssGrowthKb = resetRss && rssBefore >= 0 && peak >= 0 ? (peak > rssBefore ? peak - rssBefore : 0) : -1;
+    std::sort(times, times + reps);
+    double sum = 0;
+    for (int i = 0; i < reps; i++)
+        sum += times[i];
+    r.minMs = times[0];
+    r.medianMs = reps % 2 ? times[reps / 2] : (times[reps / 2 - 1] + times[reps / 2]) / 2;
+    r.meanMs = sum / reps;
+    r.teps = r.medianMs > 0 ? edges / (r.medianMs / 1000.0) : 0;
+    delete[] times;
+    return r;
+}
+
+static bool algoSelected(const std::string& list, const char* name) {
+    if (list.empty())
+        return true;
+    std::string padded = "," + list + ",";
+    return padded.find("," + std::string(name) + ",") != std::string::npos;
+}
+
+int main(int argc, char** argv) {
+    const int maxGraphs = 32;
+    std::string graphs[maxGraphs];
+    int numGraphs = 0;
+    std::string algos, format = "json", outPath;
+    int reps = 3, threads = 0, maxWeight = 100;
+    unsigned long long seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--graph" && hasValue && numGraphs < maxGraphs) graphs[numGraphs++] = argv[++i];
+        else if (arg == "--algo" && hasValue) algos = argv[++i];
+        else if (arg == "--reps" && hasValue) reps = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) seed = std::strtoull(argv[++i], 0, 10);
+        else if (arg == "--max-weight" && hasValue) maxWeight = std::atoi(argv[++i]);
+        else if (arg == "--format" && hasValue) format = argv[++i];
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (numGraphs == 0) {
+        graphs[numGraphs++] = "kron:12:16";
+        graphs[numGraphs++] = "grid:64:64:0.1";
+    }
+    if (reps < 1 || (format != "json" && format != "csv")) {
+        std::cerr << "Invalid --reps or --format" << std::endl;
+        return 2;
+    }
+    threads = graph::Parallel::resolve(threads);
+
+    BenchResult* results = new BenchResult[numGraphs * numBenchCases];
+    int numResults = 0;
+    // Declared outside the try block so the catch path can free it.
+    graph::DenseGraph* dense = 0;
+    try {
+        for (int gi = 0; gi < numGraphs; gi++) {
+            std::cerr << "Preparing " << graphs[gi] << "..." << std::endl;
+            graph::CSRGraph csr = makeGraph(graphs[gi], seed, maxWeight, threads);
+            graph::Graph g = csr.toGraph();
+            // Start from the highest-degree vertex so traversals cover the giant component.
+            int source = 0;
+            for (int v = 1; v < csr.getNumVertices(); v++)
+                if (csr.degree(v) > csr.degree(source))
+                    source = v;
+            // The dense backend is built only when the density selects it.
+            bool wantDense = false;
+            for (int c = 0; c < numBenchCases; c++)
+                wantDense = wantDense || (benchCases[c].dense && algoSelected(algos, benchCases[c].name));
+            if (wantDense && graph::DenseGraph::preferred(csr.getNumVertices(), csr.getNumEdges()))
+                dense = new graph::DenseGraph(graph::DenseGraph::fromGraph(g));
+            BenchInput in = {&g, &csr, dense, source, threads};
+            for (int c = 0; c < numBenchCases; c++) {
+                if (!algoSelected(algos, benchCases[c].name))
+                    continue;
+                if (benchCases[c].dense && !dense) {
+                    std::cerr << "  " << benchCases[c].name << " (skipped: graph too sparse or too large)" << std::endl;
+                    continue;
+                }
+                std::cerr << "  " << benchCases[c].name << std::endl;
+                results[numResults++] = runCase(benchCases[c], in, graphs[gi], csr.getNumEdges(), reps);
+            }
+            delete dense;
+            dense = 0;
+        }
+    } catch (const char* msg) {
+        std::cerr << "Error: " << msg << std::endl;
+        delete dense;
+        delete[] results;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath.c_str());
+        if (!file) {
+            std::cerr << "Cannot open " << outPath << std::endl;
+            delete[] results;
+            return 1;
+        }
+    }
+    std::ostream& out = outPath.empty() ? std::cout : file;
+    if (format == "json")
+        writeJson(out, results, numResults, threads);
+    else
+        writeCsv(out, results, numResults, threads);
+    delete[] results;
+    return 0;
+}
@@ -2,6 +2,23 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "Algorithms.cpp"
+#include "Centrality.cpp"
+#include "Coloring.cpp"
+#include "Communities.cpp"
+#include "Connectivity.cpp"
+#include "Cores.cpp"
+#include "DenseGraph.cpp"
+#include "Distances.cpp"
+#include "Flow.cpp"
+#include "Generators.cpp"
+#include "Matching.cpp"
+#include "MinCut.cpp"
+#include "Paths.cpp"
+#include "SmallGraph.cpp"
+#include "SpMV.cpp"
+#include "Triangles.cpp"
+#include "VersionedGraph.cpp"
+#include <functional>
 #include <iostream>
 
 // Helper functions
@@ -262,4 +279,2014 @@ TEST_CASE("Special Graph Cases") {
         CHECK(countEdges(mst) == 3);
         CHECK(isConnected(mst));
     }
-}
\ No newline at end of file
+    
+    SUBCASE("DFS on a dense graph") {
+        // Every vertex is pushed once per incident edge, far more than n times.
+        graph::Graph g(30);
+        for (int i = 0; i < 30; i++)
+            for (int j = i + 1; j < 30; j++)
+                g.addEdge(i, j, 1);
+        graph::Graph dfsTree = graph::Algorithms::dfs(g, 0);
+        CHECK(countEdges(dfsTree) == 29);
+        CHECK(isConnected(dfsTree));
+    }
+}
+
+TEST_CASE("Synthetic Generators") {
+    SUBCASE("Deterministic across thread counts") {
+        graph::CSRGraph a = graph::Generators::kronecker(8, 8, 42, 10, 1);
+        graph::CSRGraph b = graph::Generators::kronecker(8, 8, 42, 10, 4);
+        CHECK(a.getNumVertices() == 256);
+        CHECK(a.getNumEntries() == b.getNumEntries());
+        bool same = true;
+        for (int v = 0; v <= a.getNumVertices(); v++)
+            if (a.getOffsets()[v] != b.getOffsets()[v]) same = false;
+        for (long long i = 0; i < a.getNumEntries(); i++)
+            if (a.getTargets()[i] != b.getTargets()[i] || a.getWeights()[i] != b.getWeights()[i]) same = false;
+        CHECK(same);
+        graph::CSRGraph c = graph::Generators::kronecker(8, 8, 43, 10, 1);
+        CHECK(c.getNumEntries() != a.getNumEntries());
+    }
+
+    SUBCASE("Grid and Erdos-Renyi sizes") {
+        graph::CSRGraph full = graph::Generators::grid(5, 7, 0.0, 1, 1, 2);
+        CHECK(full.getNumEdges() == 5 * 6 + 4 * 7);
+        CHECK(full.degree(0) == 2);
+        CHECK(full.degree(8) == 4);
+        graph::CSRGraph er = graph::Generators::erdosRenyi(100, 500, 7, 1, 3);
+        CHECK(er.getNumEdges() == 500);
+        CHECK_THROWS(graph::Generators::grid(0, 3, 0.0, 1));
+        CHECK_THROWS(graph::Generators::rmat(4, 2, 0.6, 0.3, 0.3, 1));
+    }
+
+    SUBCASE("Random geometric graph is symmetric") {
+        graph::CSRGraph rgg = graph::Generators::randomGeometric(300, 0.1, 5, 20, 2);
+        graph::Graph g = rgg.toGraph();
+        CHECK(countEdges(g) == rgg.getNumEdges());
+        graph::CSRGraph back = graph::CSRGraph::fromGraph(g);
+        back.sortNeighbors();
+        bool same = back.getNumEntries() == rgg.getNumEntries();
+        for (long long i = 0; same && i < rgg.getNumEntries(); i++)
+            if (back.getTargets()[i] != rgg.getTargets()[i] || back.getWeights()[i] != rgg.getWeights()[i]) same = false;
+        CHECK(same);
+    }
+}
+
+TEST_CASE("Instrumentation Counters") {
+    graph::Graph g(5);
+    g.addEdge(0, 1, 1);
+    g.addEdge(0, 2, 1);
+    g.addEdge(1, 3, 1);
+    g.addEdge(2, 3, 1);
+    g.addEdge(3, 4, 1);
+    graph::Algorithms::bfs(g, 0);
+    const graph::CallStats& bfsStats = graph::Instrumentation::lastCall();
+    if (!graph::Instrumentation::enabled()) {
+        CHECK(bfsStats.routine == nullptr);
+        CHECK(bfsStats.edgesScanned == 0);
+        return;
+    }
+    CHECK(std::string(bfsStats.routine) == "bfs");
+    CHECK(bfsStats.edgesScanned == 10); // Every adjacency entry once
+    CHECK(bfsStats.levels == 4);
+    CHECK(bfsStats.frontierSizes[0] == 1);
+    CHECK(bfsStats.frontierSizes[1] == 2);
+    CHECK(bfsStats.frontierSizes[2] == 1);
+    CHECK(bfsStats.frontierSizes[3] == 1);
+
+    graph::Algorithms::dijkstra(g, 0);
+    const graph::CallStats& dijkstraStats = graph::Instrumentation::lastCall();
+    CHECK(std::string(dijkstraStats.routine) == "dijkstra");
+    CHECK(dijkstraStats.heapPushes == 5);
+    CHECK(dijkstraStats.heapPops == 5);
+    CHECK(dijkstraStats.decreaseKeys == 4);
+}
+
+TEST_CASE("Batched Edge Insertion") {
+    graph::Graph::EdgeTriple batch[] = {
+        {0, 1, 4}, {2, 0, 3}, {1, 2, 5}, {0, 1, 9}, {3, 3, 2}, {4, 1, 7}, {1, 0, 6}
+    };
+    const int count = sizeof(batch) / sizeof(batch[0]);
+
+    SUBCASE("Matches repeated addEdge") {
+        graph::Graph bulk(5), single(5);
+        bulk.addEdge(1, 3, 8);
+        single.addEdge(1, 3, 8);
+        bulk.addEdges(batch, count, false, 3);
+        for (int i = 0; i < count; i++)
+            single.addEdge(batch[i].source, batch[i].dest, batch[i].weight);
+        bool same = true;
+        for (int v = 0; v < 5; v++) {
+            graph::Graph::Edge* a = bulk.getAdjList(v);
+            graph::Graph::Edge* b = single.getAdjList(v);
+            for (; a && b; a = a->next, b = b->next)
+                if (a->destination != b->destination || a->weight != b->weight) same = false;
+            if (a || b) same = false;
+        }
+        CHECK(same);
+    }
+
+    SUBCASE("Deduplicates parallel edges") {
+        graph::Graph g(5);
+        g.addEdge(4, 1, 1);
+        g.addEdges(batch, count, true);
+        CHECK(countEdges(g) == 4); // 0-1, 0-2, 1-2, 1-4 (the self-loop is not counted)
+        CHECK(g.getAdjList(0)->weight == 4); // First occurrence wins
+        int loops = 0;
+        for (graph::Graph::Edge* e = g.getAdjList(3); e; e = e->next)
+            if (e->destination == 3) loops++;
+        CHECK(loops == 2);
+        graph::Graph::Edge* e = g.getAdjList(4);
+        CHECK((e && e->weight == 1 && e->next == nullptr)); // Existing 4-1 kept
+    }
+
+    SUBCASE("Dedup matches guarded addEdge across threads") {
+        graph::Graph bulk(300), single(300);
+        graph::Graph::EdgeTriple* edges = new graph::Graph::EdgeTriple[6000];
+        unsigned long long state = 5;
+        for (int i = 0; i < 6000; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            graph::Graph::EdgeTriple e = {static_cast<int>((state >> 33) % 300), static_cast<int>((state >> 13) % 300),
+                                          static_cast<int>(state % 97)};
+            edges[i] = e;
+            if (i < 1000) {
+                bulk.addEdge(e.source, e.dest, e.weight);
+                single.addEdge(e.source, e.dest, e.weight);
+            }
+        }
+        bulk.setIndexThreshold(24); // Mix indexed and plain lists.
+        bulk.addEdges(edges + 1000, 5000, true, 4);
+        for (int i = 1000; i < 6000; i++)
+            if (!single.hasEdge(edges[i].source, edges[i].dest))
+                single.addEdge(edges[i].source, edges[i].dest, edges[i].weight);
+        delete[] edges;
+        bool same = true;
+        for (int v = 0; v < 300; v++) {
+            graph::Graph::Edge* a = bulk.getAdjList(v);
+            graph::Graph::Edge* b = single.getAdjList(v);
+            for (; a && b; a = a->next, b = b->next)
+                if (a->destination != b->destination || a->weight != b->weight) same = false;
+            if (a || b) same = false;
+        }
+        CHECK(same);
+    }
+
+    SUBCASE("Invalid batch leaves the graph untouched") {
+        graph::Graph g(3);
+        graph::Graph::EdgeTriple bad[] = {{0, 1, 1}, {1, 3, 1}};
+        CHECK_THROWS(g.addEdges(bad, 2));
+        CHECK(countEdges(g) == 0);
+    }
+
+    SUBCASE("Large batch across threads") {
+        graph::CSRGraph er = graph::Generators::erdosRenyi(1000, 20000, 3, 50, 2);
+        graph::Graph::EdgeTriple* edges = new graph::Graph::EdgeTriple[er.getNumEdges()];
+        long long m = 0;
+        for (int u = 0; u < er.getNumVertices(); u++)
+            for (long long i = er.getOffsets()[u]; i < er.getOffsets()[u + 1]; i++)
+                if (u < er.getTargets()[i]) {
+                    graph::Graph::EdgeTriple e = {u, er.getTargets()[i], er.getWeights()[i]};
+                    edges[m++] = e;
+                }
+        graph::Graph g(1000);
+        g.addEdges(edges, m, false, 4);
+        delete[] edges;
+        CHECK(countEdges(g) == 20000);
+        graph::CSRGraph back = graph::CSRGraph::fromGraph(g);
+        back.sortNeighbors();
+        bool same = back.getNumEntries() == er.getNumEntries();
+        for (long long i = 0; same && i < er.getNumEntries(); i++)
+            if (back.getTargets()[i] != er.getTargets()[i] || back.getWeights()[i] != er.getWeights()[i]) same = false;
+        CHECK(same);
+    }
+}
+
+TEST_CASE("Versioned Graph Snapshots") {
+    SUBCASE("Snapshots are isolated from later writes") {
+        graph::Graph base(4);
+        base.addEdge(0, 1, 5);
+        base.addEdge(1, 2, 3);
+        graph::VersionedGraph vg(base);
+        {
+            graph::VersionedGraph::Snapshot before(vg);
+            vg.addEdge(2, 3, 7);
+            vg.removeEdge(0, 1);
+            CHECK(before.version() == 0);
+            CHECK(before.degree(0) == 1);
+            CHECK(before.degree(3) == 0);
+            CHECK(vg.retiredCount() == 2); // Pinned snapshot keeps versions 0 and 1 alive
+
+            graph::VersionedGraph::Snapshot after(vg);
+            CHECK(after.version() == 2);
+            CHECK(after.degree(0) == 0);
+            CHECK(after.degree(3) == 1);
+            CHECK(after.targets(3)[0] == 2);
+            CHECK(after.weights(3)[0] == 7);
+            graph::Graph g = after.toGraph();
+            CHECK(countEdges(g) == 2);
+            CHECK(hasEdge(g, 1, 2));
+            CHECK(hasEdge(g, 3, 2));
+        }
+        vg.reclaim();
+        CHECK(vg.retiredCount() == 0);
+    }
+
+    SUBCASE("Failed batches publish nothing") {
+        graph::VersionedGraph vg(3);
+        graph::VersionedGraph::Update batch[] = {{0, 1, 1, false}, {1, 2, 0, true}};
+        CHECK_THROWS(vg.apply(batch, 2));
+        CHECK(vg.currentVersion() == 0);
+        CHECK_THROWS(vg.addEdge(0, 3));
+        graph::VersionedGraph::Snapshot s(vg);
+        CHECK(s.degree(0) == 0);
+        CHECK(s.degree(1) == 0);
+    }
+
+    SUBCASE("Readers see consistent versions during writes") {
+        const int n = 3000; // Spans several block-table pages.
+        graph::VersionedGraph vg(n);
+        std::atomic<bool> done(false);
+        std::atomic<int> inconsistent(0);
+        std::atomic<long long> snapshots(0);
+        // Each version holds a perfect matching on a prefix of the vertices,
+        // so in every consistent snapshot a vertex has degree 0 or 1 and the
+        // relation is symmetric.
+        auto reader = [&]() {
+            while (!done.load()) {
+                graph::VersionedGraph::Snapshot s(vg);
+                for (int u = 0; u < n; u++) {
+                    int d = s.degree(u);
+                    if (d > 1 || (d == 1 && (s.degree(s.targets(u)[0]) != 1 || s.targets(s.targets(u)[0])[0] != u)))
+                        inconsistent++;
+                }
+                snapshots++;
+                if (vg.retiredCount() < 0) // Monitoring read while the writer commits.
+                    inconsistent++;
+            }
+        };
+        std::thread r1(reader), r2(reader);
+        for (int round = 0; round < 40; round++) {
+            for (int u = 0; u + 1 < n; u += 2) {
+                if (round % 2 == 0)
+                    vg.addEdge(u, u + 1, round);
+                else
+                    vg.removeEdge(u, u + 1);
+            }
+        }
+        done.store(true);
+        r1.join();
+        r2.join();
+        CHECK(inconsistent.load() == 0);
+        CHECK(snapshots.load() > 0);
+        vg.reclaim();
+        CHECK(vg.retiredCount() == 0);
+    }
+}
+
+TEST_CASE("Tombstone Deletion and Compaction") {
+    SUBCASE("Tombstones are versioned") {
+        graph::VersionedGraph vg(4);
+        vg.setTombstones(true, 0.5);
+        vg.addEdge(0, 1, 2);
+        vg.addEdge(0, 2, 3);
+        vg.addEdge(0, 3, 4);
+        graph::VersionedGraph::Snapshot before(vg);
+        vg.removeEdge(0, 2);
+        CHECK(before.degree(0) == 3);
+        CHECK(before.isLive(0, 1));
+        graph::VersionedGraph::Snapshot after(vg);
+        CHECK(after.degree(0) == 2);
+        CHECK(after.entries(0) == 3); // Block not copied, entry only marked
+        CHECK(after.targets(0)[1] == 2);
+        CHECK(!after.isLive(0, 1));
+        CHECK(after.degree(2) == 0);
+        graph::Graph g = after.toGraph();
+        CHECK(countEdges(g) == 2);
+        CHECK(!hasEdge(g, 0, 2));
+        CHECK(countEdges(before.toGraph()) == 3);
+    }
+
+    SUBCASE("Compaction drops dead entries") {
+        graph::VersionedGraph vg(6);
+        vg.setTombstones(true, 0.5);
+        for (int v = 1; v < 6; v++)
+            vg.addEdge(0, v, v);
+        vg.removeEdge(0, 1);
+        CHECK(vg.pendingCompactions() == 1); // Vertex 1 lost its only entry
+        vg.removeEdge(0, 2);
+        vg.removeEdge(0, 3);
+        CHECK(vg.pendingCompactions() == 4); // Vertex 0 crossed half dead
+        CHECK(vg.compact() == 4);
+        CHECK(vg.pendingCompactions() == 0);
+        graph::VersionedGraph::Snapshot s(vg);
+        CHECK(s.entries(0) == 2);
+        CHECK(s.degree(0) == 2);
+        CHECK(s.targets(0)[0] == 4);
+        CHECK(s.targets(0)[1] == 5);
+        CHECK(s.entries(1) == 0);
+        CHECK(vg.compact() == 0);
+    }
+
+    SUBCASE("Failed batches undo their tombstones") {
+        graph::VersionedGraph vg(4);
+        vg.setTombstones(true);
+        vg.addEdge(0, 1);
+        graph::VersionedGraph::Update batch[] = {{0, 1, 0, true}, {2, 3, 0, true}};
+        CHECK_THROWS(vg.apply(batch, 2));
+        graph::VersionedGraph::Snapshot s(vg);
+        CHECK(s.degree(0) == 1);
+        CHECK(s.isLive(0, 0));
+        CHECK(vg.pendingCompactions() == 0);
+    }
+
+    SUBCASE("Background compactor with concurrent readers") {
+        const int n = 2000;
+        graph::VersionedGraph vg(n);
+        vg.setTombstones(true, 0.25);
+        vg.startCompactor();
+        std::atomic<bool> done(false);
+        std::atomic<int> inconsistent(0);
+        // Same matching invariant as above, read through the live entries.
+        auto reader = [&]() {
+            while (!done.load()) {
+                graph::VersionedGraph::Snapshot s(vg);
+                for (int u = 0; u < n; u++) {
+                    int d = s.degree(u), partner = -1;
+                    for (int i = 0; i < s.entries(u); i++)
+                        if (s.isLive(u, i))
+                            partner = s.targets(u)[i];
+                    if (d > 1 || (d == 1 && s.degree(partner) != 1))
+                        inconsistent++;
+                }
+            }
+        };
+        std::thread r1(reader);
+        for (int round = 0; round < 20; round++) {
+            for (int u = 0; u + 1 < n; u += 2) {
+                if (round % 2 == 0)
+                    vg.addEdge(u, u + 1, round);
+                else
+                    vg.removeEdge(u, u + 1);
+            }
+        }
+        done.store(true);
+        r1.join();
+        vg.stopCompactor();
+        vg.compact();
+        CHECK(inconsistent.load() == 0);
+        graph::VersionedGraph::Snapshot s(vg);
+        long long entries = 0;
+        for (int u = 0; u < n; u++)
+            entries += s.entries(u);
+        CHECK(entries == 0);
+    }
+}
+
+TEST_CASE("Indexed Adjacency Lookups") {
+    SUBCASE("Lookups on a hub vertex") {
+        graph::Graph g(300);
+        g.setIndexThreshold(16);
+        for (int v = 1; v < 300; v++)
+            g.addEdge(0, v, v);
+        CHECK(g.getDegree(0) == 299);
+        CHECK(g.hasEdge(0, 150));
+        CHECK(g.hasEdge(150, 0));
+        CHECK_FALSE(g.hasEdge(1, 2));
+        CHECK(g.getWeight(0, 42) == 42);
+        g.updateWeight(42, 0, 7);
+        CHECK(g.getWeight(0, 42) == 7);
+        CHECK(g.getWeight(42, 0) == 7);
+        for (int v = 1; v < 300; v += 2)
+            g.removeEdge(0, v);
+        CHECK(g.getDegree(0) == 149);
+        CHECK_FALSE(g.hasEdge(0, 1));
+        CHECK(g.hasEdge(0, 298));
+        CHECK_THROWS(g.getWeight(0, 1));
+        CHECK_THROWS(g.updateWeight(0, 1, 3));
+        CHECK_THROWS(g.removeEdge(0, 1));
+    }
+
+    SUBCASE("Indexed and plain graphs stay identical") {
+        // Random adds (with parallel edges and self-loops) and removals applied to
+        // both graphs; list order and weights must match after every step.
+        const int n = 12;
+        graph::Graph indexed(n), plain(n);
+        indexed.setIndexThreshold(3);
+        unsigned int state = 12345;
+        auto next = [&state](int bound) {
+            state = state * 1103515245u + 12345u;
+            return static_cast<int>((state >> 16) % static_cast<unsigned int>(bound));
+        };
+        bool same = true;
+        for (int step = 0; step < 3000 && same; step++) {
+            int u = next(n), v = next(n);
+            if (next(3) == 0) {
+                bool threwA = false, threwB = false;
+                try { indexed.removeEdge(u, v); } catch (const char*) { threwA = true; }
+                try { plain.removeEdge(u, v); } catch (const char*) { threwB = true; }
+                if (threwA != threwB) same = false;
+            } else {
+                int w = next(100);
+                indexed.addEdge(u, v, w);
+                plain.addEdge(u, v, w);
+            }
+            if (step % 50 == 0) {
+                bool threwA = false, threwB = false;
+                try { indexed.updateWeight(u, v, step); } catch (const char*) { threwA = true; }
+                try { plain.updateWeight(u, v, step); } catch (const char*) { threwB = true; }
+                if (threwA != threwB) same = false;
+            }
+            for (int x = 0; x < n && same; x++) {
+                graph::Graph::Edge* a = indexed.getAdjList(x);
+                graph::Graph::Edge* b = plain.getAdjList(x);
+                for (; a && b; a = a->next, b = b->next)
+                    if (a->destination != b->destination || a->weight != b->weight) same = false;
+                if (a || b || indexed.getDegree(x) != plain.getDegree(x)) same = false;
+                for (int y = 0; y < n && same; y++)
+                    if (indexed.hasEdge(x, y) != hasEdge(plain, x, y)) same = false;
+            }
+        }
+        CHECK(same);
+        graph::Graph copy(indexed);
+        CHECK(copy.getIndexThreshold() == 3);
+        copy.setIndexThreshold(0);
+        CHECK(countEdges(copy) == countEdges(plain));
+    }
+}
+
+TEST_CASE("Copy-on-Write Sharing") {
+    graph::Graph base(6);
+    base.addEdge(0, 1, 1);
+    base.addEdge(1, 2, 2);
+    base.addEdge(2, 3, 3);
+    base.addEdge(3, 4, 4);
+
+    SUBCASE("Copies share lists until written") {
+        graph::Graph copy(base);
+        for (int v = 0; v < 6; v++)
+            CHECK(copy.getAdjList(v) == base.getAdjList(v));
+        copy.addEdge(0, 5, 9);
+        copy.removeEdge(2, 3);
+        CHECK(copy.getAdjList(1) == base.getAdjList(1)); // Untouched lists stay shared
+        CHECK(copy.getAdjList(4) == base.getAdjList(4));
+        CHECK(copy.getAdjList(0) != base.getAdjList(0));
+        CHECK(hasEdge(copy, 5, 0));
+        CHECK(!hasEdge(copy, 3, 2));
+        CHECK(countEdges(base) == 4);
+        CHECK(!hasEdge(base, 0, 5));
+        CHECK(hasEdge(base, 2, 3));
+        CHECK_THROWS(copy.removeEdge(1, 4)); // Missing edges leave lists shared
+        CHECK(copy.getAdjList(4) == base.getAdjList(4));
+
+        copy.updateWeight(3, 4, 40);
+        CHECK(copy.getWeight(4, 3) == 40);
+        CHECK(base.getWeight(4, 3) == 4);
+        base.updateWeight(0, 1, 10);
+        CHECK(copy.getWeight(1, 0) == 1);
+    }
+
+    SUBCASE("Move leaves the source empty") {
+        graph::Graph copy(base);
+        graph::Graph::Edge* head = copy.getAdjList(2);
+        graph::Graph moved(std::move(copy));
+        CHECK(copy.getNumVertices() == 0);
+        CHECK(moved.getAdjList(2) == head);
+        copy = moved; // A moved-from graph can be assigned again
+        CHECK(countEdges(copy) == 4);
+        graph::Graph tree = graph::Algorithms::bfs(moved, 0);
+        CHECK(countEdges(tree) == 4);
+    }
+
+    SUBCASE("Shared indexed lists") {
+        graph::Graph hub(40);
+        hub.setIndexThreshold(4);
+        for (int v = 1; v < 40; v++)
+            hub.addEdge(0, v, v);
+        graph::Graph copy(hub);
+        copy.removeEdge(0, 17);
+        CHECK(!copy.hasEdge(0, 17));
+        CHECK(hub.hasEdge(0, 17));
+        CHECK(copy.getDegree(0) == 38);
+        CHECK(copy.getWeight(0, 39) == 39);
+        copy.setIndexThreshold(0);
+        CHECK(hub.hasEdge(17, 0));
+        CHECK(hub.getWeight(0, 18) == 18);
+    }
+
+    SUBCASE("Copies edited on other threads") {
+        graph::Graph big = graph::Generators::erdosRenyi(500, 3000, 5).toGraph();
+        const int baseEdges = countEdges(big);
+        std::atomic<int> wrong(0);
+        // Both threads copy 'big' and unshare its lists, so the reference
+        // counts are updated concurrently.
+        auto worker = [&](int seed) {
+            for (int round = 0; round < 20; round++) {
+                graph::Graph copy(big);
+                int added = 0;
+                for (int v = 0; v < 50; v++) {
+                    int a = (seed * 50 + v) % 500, b = (v * 7 + round) % 500;
+                    copy.addEdge(a, b, seed);
+                    if (a != b)
+                        added++;
+                }
+                if (countEdges(copy) != baseEdges + added)
+                    wrong++;
+            }
+        };
+        std::thread t1(worker, 1), t2(worker, 2);
+        t1.join();
+        t2.join();
+        CHECK(wrong.load() == 0);
+        CHECK(countEdges(big) == baseEdges);
+    }
+}
+
+TEST_CASE("Dense Bitset Backend") {
+    // Hop distance from the root in a tree given as a Graph.
+    auto depths = [](const graph::Graph& tree, int root, int* depth) {
+        for (int v = 0; v < tree.getNumVertices(); v++)
+            depth[v] = -1;
+        graph::Queue q;
+        depth[root] = 0;
+        q.enqueue(root);
+        while (!q.isEmpty()) {
+            int u = q.dequeue();
+            for (graph::Graph::Edge* e = tree.getAdjList(u); e; e = e->next)
+                if (depth[e->destination] < 0) {
+                    depth[e->destination] = depth[u] + 1;
+                    q.enqueue(e->destination);
+                }
+        }
+    };
+    const int n = 150; // Spans three bitset words.
+    graph::Graph g = graph::Generators::erdosRenyi(n, 1500, 7, 50).toGraph();
+    g.addEdge(3, 3, 1);   // Self-loop
+    g.addEdge(4, 9, 100); // Parallel edge; the lighter one must win
+    graph::DenseGraph d = graph::DenseGraph::fromGraph(g);
+
+    SUBCASE("Conversion and edge operations") {
+        CHECK(graph::DenseGraph::preferred(g));
+        CHECK(!graph::DenseGraph::preferred(100000, 300000));
+        CHECK(graph::DenseGraph::preferred(4000, 4000000));
+        CHECK(!graph::DenseGraph::preferred(8000, 16000000)); // Dense, but a 256 MB weight matrix
+        CHECK(d.getWordsPerRow() == 3);
+        bool same = true;
+        for (int u = 0; u < n; u++)
+            for (int v = 0; v < n; v++)
+                if (d.hasEdge(u, v) != hasEdge(g, u, v))
+                    same = false;
+        CHECK(same);
+        graph::Graph back = d.toGraph();
+        CHECK(countEdges(back) == d.getNumEdges() - 1); // countEdges skips the self-loop
+        d.removeEdge(4, 9);
+        CHECK(!d.hasEdge(9, 4));
+        CHECK_THROWS(d.removeEdge(4, 9));
+        d.addEdge(4, 9, 5);
+        d.addEdge(9, 4, 8);
+        CHECK(d.getWeight(4, 9) == 5);
+        CHECK(d.getDegree(4) == back.getDegree(4));
+        CHECK_THROWS(graph::DenseGraph(graph::DenseGraph::MaxVertices + 1));
+    }
+
+    SUBCASE("BFS levels match the list backend") {
+        int* expected = new int[n];
+        int* actual = new int[n];
+        depths(graph::Algorithms::bfs(g, 0), 0, expected);
+        graph::Graph tree = d.bfs(0);
+        long long scanned = graph::Instrumentation::lastCall().edgesScanned;
+        depths(tree, 0, actual);
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (expected[v] != actual[v])
+                same = false;
+        CHECK(same);
+        CHECK(countEdges(tree) == countEdges(graph::Algorithms::bfs(g, 0)));
+        if (graph::Instrumentation::enabled()) {
+            long long entries = 0; // Edges, not bitset words, as the list BFS counts them
+            for (int v = 0; v < n; v++)
+                if (expected[v] >= 0)
+                    entries += d.getDegree(v);
+            CHECK(scanned == entries);
+        }
+        delete[] expected;
+        delete[] actual;
+    }
+
+    SUBCASE("Prim matches the list backend") {
+        CHECK(totalWeight(d.prim()) == totalWeight(graph::Algorithms::prim(g)));
+        graph::DenseGraph split(130); // Two components across word boundaries
+        for (int v = 1; v < 65; v++)
+            split.addEdge(v - 1, v, v % 7 + 1);
+        for (int v = 66; v < 130; v++)
+            split.addEdge(v - 1, v, 2);
+        split.addEdge(0, 64, 1);
+        graph::Graph forest = split.prim();
+        CHECK(countEdges(forest) == 128);
+        CHECK(totalWeight(forest) == totalWeight(graph::Algorithms::prim(split.toGraph())));
+    }
+}
+
+TEST_CASE("Small Graph Specialization") {
+    // Root-to-vertex path weight (or hop count) in a tree given as a Graph.
+    auto pathLengths = [](const graph::Graph& tree, int root, int* length, bool hops) {
+        for (int v = 0; v < tree.getNumVertices(); v++)
+            length[v] = -1;
+        graph::Queue q;
+        length[root] = 0;
+        q.enqueue(root);
+        while (!q.isEmpty()) {
+            int u = q.dequeue();
+            for (graph::Graph::Edge* e = tree.getAdjList(u); e; e = e->next)
+                if (length[e->destination] < 0) {
+                    length[e->destination] = length[u] + (hops ? 1 : e->weight);
+                    q.enqueue(e->destination);
+                }
+        }
+    };
+    const int n = 50;
+    graph::Graph g = graph::Generators::erdosRenyi(n, 90, 11, 20).toGraph();
+    graph::SmallGraph<64> s = graph::SmallGraph<64>::fromGraph(g);
+    int expected[n];
+
+    SUBCASE("Traversals match the list backend") {
+        graph::SmallGraph<64>::Tree t = s.bfs(0);
+        pathLengths(graph::Algorithms::bfs(g, 0), 0, expected, true);
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (t.dist[v] != expected[v])
+                same = false;
+        CHECK(same);
+        CHECK(t.getNumEdges() == countEdges(graph::Algorithms::bfs(g, 0)));
+
+        graph::SmallGraph<64>::Tree d = s.dfs(0);
+        CHECK(d.getNumEdges() == t.getNumEdges());
+        bool valid = true;
+        for (int v = 0; v < n; v++)
+            if (d.parent[v] != -1 && (!s.hasEdge(v, d.parent[v]) || d.dist[v] != d.dist[d.parent[v]] + 1))
+                valid = false;
+        CHECK(valid);
+    }
+
+    SUBCASE("Dijkstra and Prim match the list backend") {
+        graph::SmallGraph<64>::Tree t = s.dijkstra(0);
+        pathLengths(graph::Algorithms::dijkstra(g, 0), 0, expected, false);
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (t.dist[v] != expected[v])
+                same = false;
+        CHECK(same);
+        CHECK(totalWeight(s.prim().toGraph()) == totalWeight(graph::Algorithms::prim(g)));
+        CHECK(s.prim().getNumEdges() == countEdges(graph::Algorithms::prim(g)));
+    }
+
+    SUBCASE("Edge operations and limits") {
+        graph::SmallGraph<8> tiny(5);
+        tiny.addEdge(0, 1, 4);
+        tiny.addEdge(1, 0, 2); // Lighter parallel edge wins
+        tiny.addEdge(3, 4, 1);
+        CHECK(tiny.getWeight(0, 1) == 2);
+        CHECK(tiny.neighbors(1) == 1ULL);
+        CHECK(tiny.prim().getNumEdges() == 2); // Forest over two components
+        CHECK(tiny.bfs(0).dist[3] == -1);
+        tiny.removeEdge(1, 0);
+        CHECK(tiny.getDegree(0) == 0);
+        CHECK_THROWS(tiny.removeEdge(0, 1));
+        CHECK_THROWS(graph::SmallGraph<8>(9));
+        CHECK_THROWS(graph::SmallGraph<8>::fromGraph(g));
+        graph::SmallGraph<64> full(64);
+        for (int v = 1; v < 64; v++)
+            full.addEdge(v - 1, v, v);
+        CHECK(full.dijkstra(0).dist[63] == 63 * 64 / 2);
+        CHECK(full.dfs(63).dist[0] == 63);
+    }
+}
+
+TEST_CASE("Semiring SpMV Engine") {
+    graph::CSRGraph csr = graph::Generators::erdosRenyi(2000, 6000, 13, 30);
+    graph::Graph g = csr.toGraph();
+    const int n = csr.getNumVertices();
+
+    SUBCASE("Push and pull agree") {
+        graph::SpMV::Workspace ws(n);
+        double* x = new double[n]();
+        double* pushed = new double[n]();
+        double* pulled = new double[n]();
+        int* active = new int[n];
+        int* changed = new int[n];
+        long long count = 0;
+        for (int v = 0; v < n; v += 7) {
+            x[v] = v % 5 + 1;
+            active[count++] = v;
+        }
+        bool* even = new bool[n];
+        for (int v = 0; v < n; v++)
+            even[v] = v % 2 == 0;
+        graph::SpMV::Mask mask = {even, false};
+        graph::SpMV::Direction used;
+        long long a = graph::SpMV::multiply<graph::PlusTimesSemiring>(csr, x, active, count, pushed, mask, changed, ws, 2, graph::SpMV::Push, &used);
+        CHECK(used == graph::SpMV::Push);
+        long long b = graph::SpMV::multiply<graph::PlusTimesSemiring>(csr, x, active, count, pulled, mask, changed, ws, 2, graph::SpMV::Pull, &used);
+        CHECK(used == graph::SpMV::Pull);
+        CHECK(a == b);
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (pushed[v] != pulled[v] || (v % 2 == 1 && pushed[v] != 0))
+                same = false;
+        CHECK(same);
+        graph::SpMV::multiply<graph::PlusTimesSemiring>(csr, x, active, 1, pushed, graph::SpMV::all(), changed, ws, 2, graph::SpMV::Auto, &used);
+        CHECK(used == graph::SpMV::Push); // One vertex's row is far below the pull threshold
+        delete[] x;
+        delete[] pushed;
+        delete[] pulled;
+        delete[] active;
+        delete[] changed;
+        delete[] even;
+    }
+
+    SUBCASE("BFS levels and reachability") {
+        int* level = new int[n];
+        long long reached = graph::SpMV::bfsLevels(csr, 0, level, 2);
+        // Levels must equal hop distances in Algorithms::bfs's tree.
+        graph::Graph tree = graph::Algorithms::bfs(g, 0);
+        int* depth = new int[n];
+        for (int v = 0; v < n; v++)
+            depth[v] = -1;
+        graph::Queue q;
+        depth[0] = 0;
+        q.enqueue(0);
+        long long count = 0;
+        while (!q.isEmpty()) {
+            int u = q.dequeue();
+            count++;
+            for (graph::Graph::Edge* e = tree.getAdjList(u); e; e = e->next)
+                if (depth[e->destination] < 0) {
+                    depth[e->destination] = depth[u] + 1;
+                    q.enqueue(e->destination);
+                }
+        }
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (level[v] != depth[v])
+                same = false;
+        CHECK(same);
+        CHECK(reached == count);
+
+        graph::CSRGraph split = graph::CSRGraph::fromGraph(graph::Generators::grid(4, 4, 0, 1).toGraph());
+        graph::Graph twoParts(32);
+        for (int u = 0; u < 16; u++)
+            for (long long e = split.getOffsets()[u]; e < split.getOffsets()[u + 1]; e++)
+                if (u < split.getTargets()[e]) {
+                    twoParts.addEdge(u, split.getTargets()[e]);
+                    twoParts.addEdge(u + 16, split.getTargets()[e] + 16);
+                }
+        bool flags[32];
+        int sources[] = {5, 9};
+        CHECK(graph::SpMV::reachable(graph::CSRGraph::fromGraph(twoParts), sources, 2, flags) == 16);
+        CHECK(flags[0]);
+        CHECK(!flags[16]);
+        delete[] level;
+        delete[] depth;
+    }
+
+    SUBCASE("Min-plus shortest paths match Dijkstra") {
+        long long* dist = new long long[n];
+        int rounds = graph::SpMV::sssp(csr, 3, dist, 2);
+        CHECK(rounds > 1);
+        graph::Graph tree = graph::Algorithms::dijkstra(g, 3);
+        long long* expected = new long long[n];
+        for (int v = 0; v < n; v++)
+            expected[v] = graph::MinPlusSemiring::zero();
+        graph::Queue q;
+        expected[3] = 0;
+        q.enqueue(3);
+        while (!q.isEmpty()) {
+            int u = q.dequeue();
+            for (graph::Graph::Edge* e = tree.getAdjList(u); e; e = e->next)
+                if (expected[e->destination] == graph::MinPlusSemiring::zero()) {
+                    expected[e->destination] = expected[u] + e->weight;
+                    q.enqueue(e->destination);
+                }
+        }
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (dist[v] != expected[v])
+                same = false;
+        CHECK(same);
+        delete[] dist;
+        delete[] expected;
+    }
+}
+
+TEST_CASE("PageRank") {
+    SUBCASE("Matches a direct power iteration") {
+        // Reference: the textbook update on a small graph with an isolated vertex.
+        const int n = 7;
+        graph::Graph g(n);
+        int edges[][2] = {{0, 1}, {0, 2}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {3, 5}, {0, 3}};
+        for (int i = 0; i < 8; i++)
+            g.addEdge(edges[i][0], edges[i][1]);
+        graph::CSRGraph csr = graph::CSRGraph::fromGraph(g);
+        double expected[n], next[n];
+        for (int v = 0; v < n; v++)
+            expected[v] = 1.0 / n;
+        for (int it = 0; it < 200; it++) {
+            double dangling = expected[6];
+            for (int v = 0; v < n; v++) {
+                double sum = 0;
+                for (graph::Graph::Edge* e = g.getAdjList(v); e; e = e->next)
+                    sum += expected[e->destination] / g.getDegree(e->destination);
+                next[v] = 0.15 / n + 0.85 * (sum + dangling / n);
+            }
+            for (int v = 0; v < n; v++)
+                expected[v] = next[v];
+        }
+        double rank[n];
+        int iterations = graph::Centrality::pageRank(csr, rank, 0.85, 1e-12, 500, 1);
+        CHECK(iterations < 500);
+        double sum = 0;
+        for (int v = 0; v < n; v++) {
+            CHECK(rank[v] == doctest::Approx(expected[v]).epsilon(1e-9));
+            sum += rank[v];
+        }
+        CHECK(sum == doctest::Approx(1.0));
+        CHECK(rank[3] > rank[6]);
+        CHECK_THROWS(graph::Centrality::pageRank(csr, rank, 1.0));
+    }
+
+    SUBCASE("Thread counts agree") {
+        graph::CSRGraph csr = graph::Generators::rmat(12, 8, 0.57, 0.19, 0.19, 3);
+        int n = csr.getNumVertices();
+        double* one = new double[n];
+        double* four = new double[n];
+        int a = graph::Centrality::pageRank(csr, one, 0.85, 1e-10, 100, 1);
+        int b = graph::Centrality::pageRank(csr, four, 0.85, 1e-10, 100, 4);
+        CHECK(a == b);
+        double worst = 0;
+        for (int v = 0; v < n; v++)
+            worst = std::max(worst, std::abs(one[v] - four[v]));
+        CHECK(worst < 1e-12);
+        delete[] one;
+        delete[] four;
+    }
+
+    SUBCASE("Personalized PageRank stays near the seeds") {
+        // Two disjoint paths; seeding one leaves the other at zero.
+        graph::Graph g(10);
+        for (int v = 1; v < 5; v++) {
+            g.addEdge(v - 1, v);
+            g.addEdge(v + 4, v + 5);
+        }
+        graph::CSRGraph csr = graph::CSRGraph::fromGraph(g);
+        double rank[10];
+        int seeds[] = {0};
+        graph::Centrality::personalizedPageRank(csr, seeds, 1, rank);
+        CHECK(rank[0] > rank[4]); // Same degree, closer to the seed
+        CHECK(rank[1] > rank[3]);
+        CHECK(rank[7] == 0.0);
+        double sum = 0;
+        for (int v = 0; v < 10; v++)
+            sum += rank[v];
+        CHECK(sum == doctest::Approx(1.0));
+        int bad[] = {10};
+        CHECK_THROWS(graph::Centrality::personalizedPageRank(csr, bad, 1, rank));
+    }
+}
+
+TEST_CASE("Triangle Counting and Clustering") {
+    SUBCASE("Complete graph with loops and parallel edges") {
+        graph::Graph g(5);
+        for (int u = 0; u < 5; u++)
+            for (int v = u + 1; v < 5; v++)
+                g.addEdge(u, v);
+        g.addEdge(0, 1); // Ignored: parallel edge
+        g.addEdge(2, 2); // Ignored: self-loop
+        long long per[5];
+        CHECK(graph::Triangles::count(g, per) == 10);
+        CHECK(per[0] == 6);
+        CHECK(per[4] == 6);
+        double cc[5];
+        CHECK(graph::Triangles::clustering(graph::CSRGraph::fromGraph(g), cc) == doctest::Approx(1.0));
+        CHECK(cc[2] == doctest::Approx(1.0));
+    }
+
+    SUBCASE("Matches brute force across thread counts") {
+        graph::CSRGraph csr = graph::Generators::rmat(8, 12, 0.57, 0.19, 0.19, 21);
+        graph::Graph g = csr.toGraph();
+        const int n = csr.getNumVertices();
+        long long expected = 0;
+        long long* expectedPer = new long long[n]();
+        for (int u = 0; u < n; u++)
+            for (int v = u + 1; v < n; v++) {
+                if (!g.hasEdge(u, v))
+                    continue;
+                for (int w = v + 1; w < n; w++)
+                    if (g.hasEdge(u, w) && g.hasEdge(v, w)) {
+                        expected++;
+                        expectedPer[u]++;
+                        expectedPer[v]++;
+                        expectedPer[w]++;
+                    }
+            }
+        long long* per = new long long[n];
+        CHECK(graph::Triangles::count(csr, per, 1) == expected);
+        bool same = true;
+        for (int v = 0; v < n; v++)
+            if (per[v] != expectedPer[v])
+                same = false;
+        CHECK(same);
+        CHECK(graph::Triangles::count(csr, 0, 4) == expected);
+        double* cc = new double[n];
+        double average = graph::Triangles::clustering(csr, cc, 3);
+        CHECK(average > 0);
+        CHECK(average < 1);
+        delete[] expectedPer;
+        delete[] per;
+        delete[] cc;
+    }
+}
+
+TEST_CASE("K-Core Decomposition") {
+    SUBCASE("Clique with a tail") {
+        graph::Graph g(7);
+        for (int u = 0; u < 4; u++)
+            for (int v = u + 1; v < 4; v++)
+                g.addEdge(u, v);
+        g.addEdge(3, 4);
+        g.addEdge(4, 5);
+        g.addEdge(4, 5); // Ignored: parallel edge
+        g.addEdge(5, 5); // Ignored: self-loop
+        int core[7];
+        CHECK(graph::Cores::coreNumbers(g, core) == 3);
+        CHECK(core[0] == 3);
+        CHECK(core[3] == 3);
+        CHECK(core[4] == 1);
+        CHECK(core[5] == 1);
+        CHECK(core[6] == 0);
+        bool in[7];
+        CHECK(graph::Cores::kCore(graph::CSRGraph::fromGraph(g), 2, in) == 4);
+        CHECK(in[2]);
+        CHECK(!in[4]);
+    }
+
+    SUBCASE("Matches sequential peeling across thread counts") {
+        graph::CSRGraph csr = graph::Generators::rmat(10, 8, 0.57, 0.19, 0.19, 5);
+        graph::Graph g = csr.toGraph();
+        const int n = csr.getNumVertices();
+        // Reference: repeatedly remove a vertex of minimum remaining degree.
+        int* degree = new int[n];
+        bool* removed = new bool[n]();
+        int* expected = new int[n];
+        for (int v = 0; v < n; v++) {
+            degree[v] = 0;
+            for (int w = 0; w < n; w++)
+                if (w != v && g.hasEdge(v, w))
+                    degree[v]++;
+        }
+        int level = 0;
+        for (int step = 0; step < n; step++) {
+            int u = -1;
+            for (int v = 0; v < n; v++)
+                if (!removed[v] && (u < 0 || degree[v] < degree[u]))
+                    u = v;
+            if (degree[u] > level)
+                level = degree[u];
+            expected[u] = level;
+            removed[u] = true;
+            for (int w = 0; w < n; w++)
+                if (!removed[w] && w != u && g.hasEdge(u, w))
+                    degree[w]--;
+        }
+        int* core = new int[n];
+        bool same = true;
+        for (int threads = 1; threads <= 4; threads += 3) {
+            CHECK(graph::Cores::coreNumbers(csr, core, threads) == level);
+            for (int v = 0; v < n; v++)
+                if (core[v] != expected[v])
+                    same = false;
+        }
+        CHECK(same);
+        delete[] degree;
+        delete[] removed;
+        delete[] expected;
+        delete[] core;
+    }
+}
+
+TEST_CASE("Betweenness Centrality") {
+    SUBCASE("Small graphs") {
+        graph::Graph path(5);
+        for (int v = 0; v + 1 < 5; v++)
+            path.addEdge(v, v + 1);
+        double score[5];
+        graph::Centrality::betweenness(graph::CSRGraph::fromGraph(path), score);
+        CHECK(score[0] == doctest::Approx(0.0));
+        CHECK(score[1] == doctest::Approx(3.0));
+        CHECK(score[2] == doctest::Approx(4.0));
+
+        graph::Graph cycle(4);
+        for (int v = 0; v < 4; v++)
+            cycle.addEdge(v, (v + 1) % 4);
+        cycle.addEdge(1, 1); // Ignored: self-loop
+        graph::Centrality::betweenness(graph::CSRGraph::fromGraph(cycle), score, false, 2);
+        CHECK(score[1] == doctest::Approx(0.5));
+
+        graph::Graph triangle(3);
+        triangle.addEdge(0, 1, 1);
+        triangle.addEdge(1, 2, 1);
+        triangle.addEdge(0, 2, 5);
+        graph::CSRGraph csr = graph::CSRGraph::fromGraph(triangle);
+        graph::Centrality::betweenness(csr, score);
+        CHECK(score[1] == doctest::Approx(0.0));
+        graph::Centrality::betweenness(csr, score, true);
+        CHECK(score[1] == doctest::Approx(1.0));
+        CHECK(score[0] == doctest::Approx(0.0));
+    }
+
+    SUBCASE("Matches path counting and sampling bound") {
+        graph::CSRGraph csr = graph::Generators::rmat(6, 4, 0.57, 0.19, 0.19, 9);
+        const int n = csr.getNumVertices();
+        // Reference: hop distances and path counts for every pair, then
+        // sigma(s, v) * sigma(v, t) / sigma(s, t) over pairs with v on a shortest path.
+        int* mult = new int[n * n]();
+        for (int u = 0; u < n; u++)
+            for (long long e = csr.getOffsets()[u]; e < csr.getOffsets()[u + 1]; e++)
+                if (csr.getTargets()[e] != u)
+                    mult[u * n + csr.getTargets()[e]]++;
+        int* dist = new int[n * n];
+        double* sigma = new double[n * n]();
+        for (int s = 0; s < n; s++) {
+            for (int v = 0; v < n; v++)
+                dist[s * n + v] = -1;
+            dist[s * n + s] = 0;
+            sigma[s * n + s] = 1;
+            for (int d = 0; d < n; d++)
+                for (int u = 0; u < n; u++)
+                    if (dist[s * n + u] == d)
+                        for (int v = 0; v < n; v++)
+                            if (mult[u * n + v] && (dist[s * n + v] < 0 || dist[s * n + v] == d + 1)) {
+                                dist[s * n + v] = d + 1;
+                                sigma[s * n + v] += sigma[s * n + u] * mult[u * n + v];
+                            }
+        }
+        double* expected = new double[n]();
+        for (int s = 0; s < n; s++)
+            for (int t = s + 1; t < n; t++)
+                for (int v = 0; v < n; v++)
+                    if (v != s && v != t && dist[s * n + t] > 0 && dist[s * n + v] >= 0 &&
+                        dist[s * n + v] + dist[v * n + t] == dist[s * n + t])
+                        expected[v] += sigma[s * n + v] * sigma[v * n + t] / sigma[s * n + t];
+        double* score = new double[n];
+        bool same = true;
+        for (int threads = 1; threads <= 3; threads += 2) {
+            graph::Centrality::betweenness(csr, score, false, threads);
+            for (int v = 0; v < n; v++)
+                if (score[v] != doctest::Approx(expected[v]))
+                    same = false;
+            // Unit weights: Dijkstra must agree with BFS.
+            graph::Centrality::betweenness(csr, score, true, threads);
+            for (int v = 0; v < n; v++)
+                if (score[v] != doctest::Approx(expected[v]))
+                    same = false;
+        }
+        CHECK(same);
+        int samples = graph::Centrality::betweennessSamples(n, 0.05);
+        double bound = graph::Centrality::betweennessSampled(csr, samples, score, 7, 0.95, false, 2);
+        CHECK(bound == doctest::Approx(0.05 * n * (n - 2) / 2).epsilon(0.01));
+        bool within = true;
+        for (int v = 0; v < n; v++)
+            if (score[v] < expected[v] - bound || score[v] > expected[v] + bound)
+                within = false;
+        CHECK(within);
+        CHECK_THROWS(graph::Centrality::betweennessSampled(csr, 0, score, 7));
+        delete[] mult;
+        delete[] dist;
+        delete[] sigma;
+        delete[] expected;
+        delete[] score;
+    }
+}
+
+TEST_CASE("Community Detection") {
+    // Four 8-cliques joined in a ring by single edges.
+    graph::Graph g(32);
+    for (int c = 0; c < 4; c++) {
+        for (int u = 0; u < 8; u++)
+            for (int v = u + 1; v < 8; v++)
+                g.addEdge(8 * c + u, 8 * c + v);
+        g.addEdge(8 * c, (8 * c + 11) % 32);
+    }
+    graph::CSRGraph csr = graph::CSRGraph::fromGraph(g);
+    int community[32];
+    int expected[32];
+    for (int v = 0; v < 32; v++)
+        expected[v] = v / 8;
+    double best = graph::Communities::modularity(csr, expected);
+    CHECK(best == doctest::Approx(4 * (56.0 / 232 - (58.0 / 232) * (58.0 / 232))));
+
+    SUBCASE("Louvain") {
+        for (int threads = 1; threads <= 4; threads += 3) {
+            CHECK(graph::Communities::louvain(g, community, 1.0, threads) == 4);
+            bool same = true;
+            for (int v = 0; v < 32; v++)
+                if (community[v] != expected[v])
+                    same = false;
+            CHECK(same);
+            CHECK(graph::Communities::modularity(csr, community) == doctest::Approx(best));
+        }
+        // Low resolution favours merging.
+        CHECK(graph::Communities::louvain(csr, community, 0.05) < 4);
+        graph::Graph empty(3);
+        CHECK(graph::Communities::louvain(empty, community) == 3);
+        CHECK(graph::Communities::modularity(graph::CSRGraph::fromGraph(empty), community) == 0.0);
+    }
+
+    SUBCASE("Label propagation") {
+        // Neighbouring cliques may merge, but no clique is split.
+        for (int threads = 1; threads <= 4; threads += 3) {
+            int count = graph::Communities::labelPropagation(g, community, 20, 3, threads);
+            CHECK(count >= 1);
+            CHECK(count <= 4);
+            bool whole = true;
+            for (int v = 0; v < 32; v++)
+                if (community[v] != community[v / 8 * 8])
+                    whole = false;
+            CHECK(whole);
+        }
+    }
+
+    SUBCASE("Many cliques use hashed tallies") {
+        // 64 cliques: degrees stay small next to n, so the per-thread
+        // tallies hash labels instead of indexing them.
+        graph::Graph ring(512);
+        for (int c = 0; c < 64; c++) {
+            for (int u = 0; u < 8; u++)
+                for (int v = u + 1; v < 8; v++)
+                    ring.addEdge(8 * c + u, 8 * c + v);
+            ring.addEdge(8 * c, (8 * c + 11) % 512);
+        }
+        int* ids = new int[512];
+        for (int threads = 1; threads <= 4; threads += 3) {
+            CHECK(graph::Communities::labelPropagation(ring, ids, 20, 3, threads) <= 64);
+            bool whole = true;
+            for (int v = 0; v < 512; v++)
+                if (ids[v] != ids[v / 8 * 8])
+                    whole = false;
+            CHECK(whole);
+            graph::Communities::louvain(ring, ids, 1.0, threads);
+            whole = true;
+            for (int v = 0; v < 512; v++)
+                if (ids[v] != ids[v / 8 * 8])
+                    whole = false;
+            CHECK(whole);
+        }
+        delete[] ids;
+    }
+
+    SUBCASE("Louvain on a generated graph") {
+        graph::CSRGraph big = graph::Generators::rmat(10, 8, 0.57, 0.19, 0.19, 3);
+        int* ids = new int[big.getNumVertices()];
+        int count = graph::Communities::louvain(big, ids, 1.0, 3);
+        CHECK(count > 1);
+        CHECK(count < big.getNumVertices());
+        CHECK(graph::Communities::modularity(big, ids) > 0.12);
+        delete[] ids;
+    }
+}
+
+// Edmonds-Karp on a dense capacity matrix, for checking the push-relabel solvers.
+static long long referenceFlow(int n, long long* cap, int s, int t) {
+    long long flow = 0;
+    int* parent = new int[n];
+    int* queue = new int[n];
+    while (true) {
+        for (int v = 0; v < n; v++)
+            parent[v] = -1;
+        parent[s] = s;
+        int head = 0, tail = 0;
+        queue[tail++] = s;
+        while (head < tail && parent[t] < 0) {
+            int u = queue[head++];
+            for (int v = 0; v < n; v++)
+                if (parent[v] < 0 && cap[u * n + v] > 0) {
+                    parent[v] = u;
+                    queue[tail++] = v;
+                }
+        }
+        if (parent[t] < 0)
+            break;
+        long long push = -1;
+        for (int v = t; v != s; v = parent[v])
+            if (push < 0 || cap[parent[v] * n + v] < push)
+                push = cap[parent[v] * n + v];
+        for (int v = t; v != s; v = parent[v]) {
+            cap[parent[v] * n + v] -= push;
+            cap[v * n + parent[v]] += push;
+        }
+        flow += push;
+    }
+    delete[] parent;
+    delete[] queue;
+    return flow;
+}
+
+TEST_CASE("Max Flow and Min Cut") {
+    SUBCASE("Small networks") {
+        // Classic directed example with maximum flow 23.
+        int src[] = {0, 0, 1, 2, 1, 3, 2, 4, 3, 4};
+        int dst[] = {1, 2, 2, 1, 3, 2, 4, 3, 5, 5};
+        int cap[] = {16, 13, 10, 4, 12, 9, 14, 7, 20, 4};
+        graph::FlowNetwork net = graph::FlowNetwork::fromArcs(6, src, dst, cap, 10);
+        bool side[6];
+        CHECK(graph::MaxFlow::solve(net, 0, 5, side) == 23);
+        CHECK(side[0]);
+        CHECK(!side[5]);
+        CHECK(graph::MaxFlow::solveParallel(net, 0, 5, 0, 3) == 23);
+        CHECK(graph::MaxFlow::solve(net, 5, 0) == 0);
+
+        graph::Graph g(4);
+        g.addEdge(0, 1, 3);
+        g.addEdge(1, 3, 2);
+        g.addEdge(0, 2, 1);
+        g.addEdge(2, 3, 5);
+        g.addEdge(1, 2, 1);
+        g.addEdge(2, 2, 9); // Ignored: self-loop
+        CHECK(graph::MaxFlow::minCut(g, 0, 3, side) == 4);
+        CHECK(graph::MaxFlow::minCut(g, 3, 0, 0, 2) == 4);
+        CHECK_THROWS(graph::MaxFlow::minCut(g, 1, 1));
+    }
+
+    SUBCASE("Matches Edmonds-Karp") {
+        bool same = true, cutMatches = true;
+        for (int seed = 1; seed <= 6; seed++) {
+            graph::CSRGraph csr = graph::Generators::rmat(6, 4, 0.57, 0.19, 0.19, seed, 20);
+            graph::Graph g = csr.toGraph();
+            const int n = g.getNumVertices();
+            long long* cap = new long long[n * n]();
+            for (int u = 0; u < n; u++)
+                for (graph::Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next)
+                    if (e->destination != u)
+                        cap[u * n + e->destination] += e->weight;
+            long long expected = referenceFlow(n, cap, 0, n - 1);
+            graph::FlowNetwork net = graph::FlowNetwork::fromGraph(g);
+            bool* side = new bool[n];
+            long long flow = graph::MaxFlow::solve(net, 0, n - 1, side);
+            if (flow != expected || graph::MaxFlow::solveParallel(net, 0, n - 1, 0, 4) != expected)
+                same = false;
+            long long cut = 0;
+            for (int u = 0; u < n; u++)
+                for (long long a = net.getOffsets()[u]; a < net.getOffsets()[u + 1]; a++)
+                    if (side[u] && !side[net.getTargets()[a]])
+                        cut += net.getCapacities()[a];
+            if (cut != expected || !side[0] || side[n - 1])
+                cutMatches = false;
+            delete[] cap;
+            delete[] side;
+        }
+        CHECK(same);
+        CHECK(cutMatches);
+    }
+}
+
+// Simple augmenting paths (Kuhn), for checking Hopcroft-Karp.
+static bool kuhnAugment(const graph::Graph& g, int u, int* mate, bool* seen) {
+    for (graph::Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next) {
+        int r = e->destination;
+        if (seen[r])
+            continue;
+        seen[r] = true;
+        if (mate[r] < 0 || kuhnAugment(g, mate[r], mate, seen)) {
+            mate[r] = u;
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("Bipartite Matching") {
+    SUBCASE("Small graphs") {
+        // Greedy matches 0-3 first; the maximum needs the augmenting path 1-3-0-4.
+        graph::Graph g(6);
+        g.addEdge(0, 3);
+        g.addEdge(0, 4);
+        g.addEdge(1, 3);
+        g.addEdge(2, 4);
+        g.addEdge(2, 5);
+        int mate[6];
+        CHECK(graph::Matching::hopcroftKarp(g, mate) == 3);
+        bool consistent = true;
+        for (int v = 0; v < 6; v++)
+            if (mate[v] < 0 || mate[mate[v]] != v || !hasEdge(g, v, mate[v]))
+                consistent = false;
+        CHECK(consistent);
+        graph::Graph odd(3);
+        odd.addEdge(0, 1);
+        odd.addEdge(1, 2);
+        odd.addEdge(2, 0);
+        CHECK_THROWS(graph::Matching::hopcroftKarp(odd, mate));
+        bool left[] = {true, false, true};
+        CHECK_THROWS(graph::Matching::hopcroftKarp(odd, mate, left));
+    }
+
+    SUBCASE("Matches augmenting paths") {
+        bool same = true, valid = true;
+        for (int seed = 1; seed <= 5; seed++) {
+            // Random edges between [0, 300) and [300, 500).
+            graph::CSRGraph random = graph::Generators::erdosRenyi(500, 700, seed);
+            graph::Graph g(500);
+            for (int u = 0; u < 300; u++)
+                for (long long e = random.getOffsets()[u]; e < random.getOffsets()[u + 1]; e++)
+                    g.addEdge(u, 300 + random.getTargets()[e] % 200);
+            int* expectedMate = new int[500];
+            bool* seen = new bool[500];
+            for (int v = 0; v < 500; v++)
+                expectedMate[v] = -1;
+            int expected = 0;
+            for (int u = 0; u < 300; u++) {
+                for (int v = 0; v < 500; v++)
+                    seen[v] = false;
+                if (kuhnAugment(g, u, expectedMate, seen))
+                    expected++;
+            }
+            bool* left = new bool[500];
+            for (int v = 0; v < 500; v++)
+                left[v] = v < 300;
+            int* mate = new int[500];
+            for (int threads = 1; threads <= 4; threads += 3) {
+                if (graph::Matching::hopcroftKarp(g, mate, left, threads) != expected)
+                    same = false;
+                for (int v = 0; v < 500; v++)
+                    if (mate[v] >= 0 && (mate[mate[v]] != v || !hasEdge(g, v, mate[v])))
+                        valid = false;
+            }
+            delete[] expectedMate;
+            delete[] seen;
+            delete[] left;
+            delete[] mate;
+        }
+        CHECK(same);
+        CHECK(valid);
+    }
+
+    SUBCASE("Long augmenting path") {
+        // A path l0-r0-l1-r1-...; left vertices are numbered from the far end,
+        // so greedy matches each l(i) to r(i-1) and leaves l0 and r(k-1) free.
+        // The one augmenting path runs the full length, past the initial
+        // search stack.
+        const int k = 100;
+        graph::Graph g(2 * k);
+        for (int i = 0; i < k; i++) {
+            if (i > 0)
+                g.addEdge(k - 1 - i, k + i - 1); // First in l(i)'s list
+            g.addEdge(k - 1 - i, k + i);
+        }
+        int mate[2 * k];
+        for (int threads = 1; threads <= 4; threads += 3) {
+            CHECK(graph::Matching::hopcroftKarp(g, mate, nullptr, threads) == k);
+            bool perfect = true;
+            for (int i = 0; i < k; i++)
+                if (mate[k - 1 - i] != k + i)
+                    perfect = false;
+            CHECK(perfect);
+        }
+    }
+}
+
+TEST_CASE("Graph Coloring") {
+    SUBCASE("Small graphs") {
+        graph::Graph k5(5);
+        for (int u = 0; u < 5; u++)
+            for (int v = u + 1; v < 5; v++)
+                k5.addEdge(u, v);
+        k5.addEdge(2, 2); // Ignored: self-loop
+        int color[5];
+        CHECK(graph::Coloring::speculative(k5, color) == 5);
+        CHECK(graph::Coloring::jonesPlassmann(k5, color, graph::Coloring::LargestFirst) == 5);
+        CHECK(graph::Coloring::isProper(graph::CSRGraph::fromGraph(k5), color));
+        graph::CSRGraph grid = graph::Generators::grid(20, 30, 0.0, 1);
+        int* gridColor = new int[600];
+        CHECK(graph::Coloring::speculative(grid, gridColor, graph::Coloring::Natural, 1) == 2);
+        delete[] gridColor;
+    }
+
+    SUBCASE("Proper across orderings and threads") {
+        graph::CSRGraph csr = graph::Generators::rmat(11, 8, 0.57, 0.19, 0.19, 4);
+        const int n = csr.getNumVertices();
+        long long maxDegree = 0;
+        for (int v = 0; v < n; v++)
+            if (csr.degree(v) > maxDegree)
+                maxDegree = csr.degree(v);
+        int* color = new int[n];
+        int* first = new int[n];
+        bool proper = true, bounded = true, deterministic = true;
+        for (int threads = 1; threads <= 4; threads += 3)
+            for (int o = 0; o < 2; o++) {
+                graph::Coloring::Ordering ordering = o ? graph::Coloring::LargestFirst : graph::Coloring::Natural;
+                int count = graph::Coloring::speculative(csr, color, ordering, threads);
+                proper = proper && graph::Coloring::isProper(csr, color);
+                bounded = bounded && count <= maxDegree + 1;
+                count = graph::Coloring::jonesPlassmann(csr, color, ordering, 7, threads);
+                proper = proper && graph::Coloring::isProper(csr, color);
+                bounded = bounded && count <= maxDegree + 1;
+                if (threads == 1 && o == 0)
+                    std::copy(color, color + n, first);
+                if (threads > 1 && o == 0)
+                    deterministic = std::equal(color, color + n, first);
+            }
+        CHECK(proper);
+        CHECK(bounded);
+        CHECK(deterministic);
+        delete[] color;
+        delete[] first;
+    }
+
+    SUBCASE("Recolor repairs pre-seeded conflicts") {
+        graph::Graph path(4);
+        for (int v = 0; v < 3; v++)
+            path.addEdge(v, v + 1);
+        graph::CSRGraph line = graph::CSRGraph::fromGraph(path);
+        int seeded[] = {0, 0, 0, 0}; // Every edge clashes; vertices 1-3 retry.
+        CHECK(graph::Coloring::recolor(line, seeded) == 3);
+        CHECK(seeded[0] == 0);
+        CHECK(graph::Coloring::isProper(line, seeded));
+        int high[] = {7, 1, 0, 1}; // 7 exceeds the degree of vertex 0
+        graph::Coloring::recolor(line, high);
+        CHECK(high[0] == 0);
+        CHECK(high[3] == 1); // Kept
+        int bad[] = {0, -2, 0, 1};
+        CHECK_THROWS(graph::Coloring::recolor(line, bad));
+
+        // Colour a graph, then add edges that join equal colours and repair.
+        graph::CSRGraph csr = graph::Generators::rmat(10, 8, 0.57, 0.19, 0.19, 9);
+        const int n = csr.getNumVertices();
+        int* color = new int[n];
+        int* before = new int[n];
+        graph::Coloring::speculative(csr, color, graph::Coloring::Natural, 4);
+        graph::Graph g = csr.toGraph();
+        int added = 0;
+        for (int u = 0; u < n && added < 200; u++)
+            for (int v = u + 1; v < n && added < 200; v += 37)
+                if (color[u] == color[v]) {
+                    g.addEdge(u, v);
+                    added++;
+                }
+        graph::CSRGraph grown = graph::CSRGraph::fromGraph(g);
+        CHECK(!graph::Coloring::isProper(grown, color));
+        std::copy(color, color + n, before);
+        bool bounded = true;
+        for (int threads = 1; threads <= 4; threads += 3) {
+            std::copy(before, before + n, color);
+            graph::Coloring::recolor(grown, color, graph::Coloring::LargestFirst, threads);
+            CHECK(graph::Coloring::isProper(grown, color));
+            for (int v = 0; v < n; v++)
+                if (color[v] > grown.degree(v))
+                    bounded = false;
+        }
+        CHECK(bounded);
+        delete[] color;
+        delete[] before;
+    }
+}
+
+TEST_CASE("Connectivity") {
+    SUBCASE("Strongly connected components agree with mutual reachability") {
+        bool agree = true;
+        for (int trial = 0; trial < 30 && agree; trial++) {
+            const int n = 30;
+            const int m = 20 + trial * 2;
+            int src[80], dst[80];
+            unsigned long long state = 12345 + trial;
+            for (int i = 0; i < m; i++) {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                src[i] = static_cast<int>((state >> 33) % n);
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                dst[i] = static_cast<int>((state >> 33) % n);
+            }
+            bool reach[n][n] = {};
+            for (int v = 0; v < n; v++)
+                reach[v][v] = true;
+            for (int i = 0; i < m; i++)
+                reach[src[i]][dst[i]] = true;
+            for (int k = 0; k < n; k++)
+                for (int i = 0; i < n; i++)
+                    for (int j = 0; j < n; j++)
+                        if (reach[i][k] && reach[k][j])
+                            reach[i][j] = true;
+            for (int trim = 0; trim < 2; trim++) {
+                int component[n];
+                int count = graph::Connectivity::stronglyConnected(n, src, dst, m, component, trim == 1, 4);
+                for (int i = 0; i < n; i++) {
+                    if (component[i] < 0 || component[i] >= count)
+                        agree = false;
+                    for (int j = 0; j < n; j++)
+                        if ((component[i] == component[j]) != (reach[i][j] && reach[j][i]))
+                            agree = false;
+                }
+            }
+        }
+        CHECK(agree);
+    }
+
+    SUBCASE("Long chains do not overflow the stack") {
+        const int n = 1000000;
+        int* src = new int[n];
+        int* dst = new int[n];
+        for (int i = 0; i < n - 1; i++) {
+            src[i] = i;
+            dst[i] = i + 1;
+        }
+        src[n - 1] = n - 1;
+        dst[n - 1] = 0;
+        int* component = new int[n];
+        CHECK(graph::Connectivity::stronglyConnected(n, src, dst, n, component, true, 4) == 1);
+        CHECK(graph::Connectivity::stronglyConnected(n, src, dst, n - 1, component, false) == n);
+        graph::CSRGraph path = graph::CSRGraph::fromEdges(n, src, dst, 0, n - 1);
+        bool* isBridge = new bool[path.getNumEntries()];
+        bool* isCut = new bool[n];
+        CHECK(graph::Connectivity::bridges(path, isBridge) == n - 1);
+        CHECK(graph::Connectivity::articulationPoints(path, isCut) == n - 2);
+        delete[] src;
+        delete[] dst;
+        delete[] component;
+        delete[] isBridge;
+        delete[] isCut;
+    }
+
+    SUBCASE("Bridges and articulation points agree with removal") {
+        bool agree = true;
+        for (int trial = 0; trial < 30 && agree; trial++) {
+            const int n = 16;
+            graph::Graph g = graph::Generators::erdosRenyi(n, 18 + trial % 10, 7 + trial).toGraph();
+            if (trial % 3 == 0)
+                g.addEdge(0, 1, 1); // Possibly a parallel edge.
+            graph::CSRGraph csr = graph::CSRGraph::fromGraph(g);
+            const long long* offsets = csr.getOffsets();
+            const int* targets = csr.getTargets();
+            // Components without skipVertex and without the edges {a, b}.
+            auto components = [&](int skipVertex, int a, int b) {
+                int label[n];
+                for (int v = 0; v < n; v++)
+                    label[v] = -1;
+                int count = 0;
+                for (int root = 0; root < n; root++) {
+                    if (root == skipVertex || label[root] >= 0)
+                        continue;
+                    int queue[n], tail = 0;
+                    label[root] = count;
+                    queue[tail++] = root;
+                    for (int head = 0; head < tail; head++)
+                        for (long long e = offsets[queue[head]]; e < offsets[queue[head] + 1]; e++) {
+                            int w = targets[e];
+                            bool skipped = (queue[head] == a && w == b) || (queue[head] == b && w == a);
+                            if (w != skipVertex && !skipped && label[w] < 0) {
+                                label[w] = count;
+                                queue[tail++] = w;
+                            }
+                        }
+                    count++;
+                }
+                return count;
+            };
+            int base = components(-1, -1, -1);
+            bool* isBridge = new bool[csr.getNumEntries()];
+            bool isCut[n];
+            graph::Connectivity::bridges(csr, isBridge);
+            graph::Connectivity::articulationPoints(csr, isCut);
+            for (int u = 0; u < n; u++) {
+                bool isolated = offsets[u] == offsets[u + 1];
+                if (isCut[u] != (components(u, -1, -1) > base - (isolated ? 1 : 0)))
+                    agree = false;
+                for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                    int copies = 0;
+                    for (long long f = offsets[u]; f < offsets[u + 1]; f++)
+                        if (targets[f] == targets[e])
+                            copies++;
+                    bool expected = targets[e] != u && copies == 1 && components(-1, u, targets[e]) > base;
+                    if (isBridge[e] != expected)
+                        agree = false;
+                }
+            }
+            delete[] isBridge;
+        }
+        CHECK(agree);
+    }
+
+    SUBCASE("Biconnected components") {
+        // Two triangles sharing vertex 2, a pendant edge 4-5, and an isolated vertex 6.
+        int src[] = {0, 1, 2, 2, 3, 4, 4};
+        int dst[] = {1, 2, 0, 3, 4, 2, 5};
+        graph::CSRGraph g = graph::CSRGraph::fromEdges(7, src, dst, 0, 7);
+        int* component = new int[g.getNumEntries()];
+        CHECK(graph::Connectivity::biconnectedComponents(g, component) == 3);
+        const long long* offsets = g.getOffsets();
+        const int* targets = g.getTargets();
+        auto block = [&](int u, int v) {
+            for (long long e = offsets[u]; e < offsets[u + 1]; e++)
+                if (targets[e] == v)
+                    return component[e];
+            return -2;
+        };
+        CHECK(block(0, 1) == block(1, 2));
+        CHECK(block(0, 1) == block(2, 0));
+        CHECK(block(2, 3) == block(3, 4));
+        CHECK(block(2, 3) == block(4, 2));
+        CHECK(block(0, 1) != block(2, 3));
+        CHECK(block(4, 5) != block(2, 3));
+        CHECK(block(4, 5) != block(0, 1));
+        bool symmetric = true;
+        for (int u = 0; u < 7; u++)
+            for (long long e = offsets[u]; e < offsets[u + 1]; e++)
+                if (block(targets[e], u) != component[e])
+                    symmetric = false;
+        CHECK(symmetric);
+        bool isCut[7];
+        CHECK(graph::Connectivity::articulationPoints(g, isCut) == 2);
+        CHECK(isCut[2]);
+        CHECK(isCut[4]);
+        // Graph overloads index entries in adjacency-list order.
+        graph::Graph lists(7);
+        for (int i = 0; i < 7; i++)
+            lists.addEdge(src[i], dst[i]);
+        graph::CSRGraph laid = graph::CSRGraph::fromGraph(lists);
+        int* fromLists = new int[laid.getNumEntries()];
+        int* fromCsr = new int[laid.getNumEntries()];
+        bool* bridgeLists = new bool[laid.getNumEntries()];
+        bool* bridgeCsr = new bool[laid.getNumEntries()];
+        CHECK(graph::Connectivity::biconnectedComponents(lists, fromLists) == 3);
+        graph::Connectivity::biconnectedComponents(laid, fromCsr);
+        CHECK(std::equal(fromLists, fromLists + laid.getNumEntries(), fromCsr));
+        CHECK(graph::Connectivity::bridges(lists, bridgeLists) == 1); // 4-5
+        graph::Connectivity::bridges(laid, bridgeCsr);
+        CHECK(std::equal(bridgeLists, bridgeLists + laid.getNumEntries(), bridgeCsr));
+        delete[] fromLists;
+        delete[] fromCsr;
+        delete[] bridgeLists;
+        delete[] bridgeCsr;
+        delete[] component;
+    }
+}
+
+TEST_CASE("Global Minimum Cut") {
+    // Weight of the edges crossing side.
+    auto cutWeight = [](const graph::Graph& g, const bool* side) {
+        long long w = 0;
+        for (int u = 0; u < g.getNumVertices(); u++)
+            for (graph::Graph::Edge* e = g.getAdjList(u); e != nullptr; e = e->next)
+                if (u < e->destination && side[u] != side[e->destination])
+                    w += e->weight;
+        return w;
+    };
+    auto properShores = [](const bool* side, int n) {
+        int count = 0;
+        for (int v = 0; v < n; v++)
+            count += side[v];
+        return count > 0 && count < n;
+    };
+
+    SUBCASE("Two cliques joined by a light edge") {
+        graph::Graph g(8);
+        for (int base = 0; base < 8; base += 4)
+            for (int i = 0; i < 4; i++)
+                for (int j = i + 1; j < 4; j++)
+                    g.addEdge(base + i, base + j, 3);
+        g.addEdge(1, 6, 2);
+        bool side[8];
+        CHECK(graph::MinCut::stoerWagner(g, side) == 2);
+        CHECK(side[0] == side[3]);
+        CHECK(side[0] != side[4]);
+        CHECK(graph::MinCut::kargerStein(g, side) == 2);
+        CHECK(cutWeight(g, side) == 2);
+    }
+
+    SUBCASE("Agreement with exhaustive search") {
+        bool agree = true;
+        for (int trial = 0; trial < 20 && agree; trial++) {
+            const int n = 10;
+            graph::Graph g = graph::Generators::erdosRenyi(n, 14 + trial, 5 + trial, 9).toGraph();
+            long long best = -1;
+            bool side[n];
+            for (int mask = 1; mask < (1 << (n - 1)); mask++) {
+                for (int v = 0; v < n; v++)
+                    side[v] = (mask >> v) & 1;
+                long long w = cutWeight(g, side);
+                if (best < 0 || w < best)
+                    best = w;
+            }
+            long long sw = graph::MinCut::stoerWagner(g, side);
+            if (sw != best || cutWeight(g, side) != best || !properShores(side, n))
+                agree = false;
+            long long ks = graph::MinCut::kargerStein(g, side, 0, trial, 2);
+            if (ks != best || cutWeight(g, side) != best || !properShores(side, n))
+                agree = false;
+        }
+        CHECK(agree);
+    }
+
+    SUBCASE("Karger-Stein on larger graphs") {
+        bool agree = true, deterministic = true, sameScans = true;
+        for (int trial = 0; trial < 5; trial++) {
+            const int n = 80;
+            graph::Graph g = graph::Generators::erdosRenyi(n, 400, 11 + trial, 20).toGraph();
+            bool side[n], other[n];
+            long long sw = graph::MinCut::stoerWagner(g, side);
+            if (cutWeight(g, side) != sw || !properShores(side, n))
+                agree = false;
+            long long ks = graph::MinCut::kargerStein(g, side, 0, trial, 4);
+            long long scanned = graph::Instrumentation::lastCall().edgesScanned;
+            if (ks != sw || cutWeight(g, side) != ks || !properShores(side, n))
+                agree = false;
+            if (graph::MinCut::kargerStein(g, other, 0, trial, 1) != ks || !std::equal(side, side + n, other))
+                deterministic = false;
+            // Contractions on worker threads must still reach the caller's record.
+            if (graph::Instrumentation::lastCall().edgesScanned != scanned)
+                sameScans = false;
+            if (graph::Instrumentation::enabled() && scanned == 0)
+                sameScans = false;
+        }
+        CHECK(agree);
+        CHECK(deterministic);
+        CHECK(sameScans);
+    }
+
+    SUBCASE("Disconnected graphs and invalid input") {
+        graph::Graph g(5);
+        g.addEdge(0, 1, 4);
+        g.addEdge(2, 3, 1);
+        g.addEdge(3, 4, 7);
+        bool side[5];
+        CHECK(graph::MinCut::stoerWagner(g, side) == 0);
+        CHECK(cutWeight(g, side) == 0);
+        CHECK(graph::MinCut::kargerStein(g, side) == 0);
+        CHECK(cutWeight(g, side) == 0);
+        CHECK(properShores(side, 5));
+        g.addEdge(1, 2, -1);
+        CHECK_THROWS(graph::MinCut::stoerWagner(g));
+        graph::Graph single(1);
+        CHECK_THROWS(graph::MinCut::kargerStein(single));
+    }
+}
+
+TEST_CASE("K Shortest Paths") {
+    SUBCASE("Agreement with exhaustive enumeration") {
+        bool agree = true, deterministic = true;
+        for (int trial = 0; trial < 25 && agree; trial++) {
+            const int n = 9;
+            graph::CSRGraph g = graph::Generators::erdosRenyi(n, 14 + trial % 6, 3 + trial, 6);
+            const long long* offsets = g.getOffsets();
+            const int* targets = g.getTargets();
+            const int* weights = g.getWeights();
+            // Every simple 0 -> n-1 path length (lightest parallel edge per step).
+            long long all[100000];
+            int numAll = 0;
+            bool onPath[n] = {};
+            std::function<void(int, long long)> walk = [&](int u, long long length) {
+                if (u == n - 1) {
+                    all[numAll++] = length;
+                    return;
+                }
+                onPath[u] = true;
+                for (long long e = offsets[u]; e < offsets[u + 1]; e++) {
+                    int v = targets[e];
+                    bool lightest = true;
+                    for (long long f = offsets[u]; f < offsets[u + 1]; f++)
+                        if (targets[f] == v && (weights[f] < weights[e] || (weights[f] == weights[e] && f < e)))
+                            lightest = false;
+                    if (!onPath[v] && lightest)
+                        walk(v, length + weights[e]);
+                }
+                onPath[u] = false;
+            };
+            walk(0, 0);
+            std::sort(all, all + numAll);
+            const int k = 6;
+            graph::PathList paths = graph::Paths::kShortest(g, 0, n - 1, k);
+            if (paths.size() != std::min(k, numAll))
+                agree = false;
+            for (int i = 0; i < paths.size() && agree; i++) {
+                if (paths.length(i) != all[i])
+                    agree = false;
+                const int* p = paths.vertices(i);
+                if (p[0] != 0 || p[paths.count(i) - 1] != n - 1)
+                    agree = false;
+                for (int a = 0; a < paths.count(i); a++)
+                    for (int b = a + 1; b < paths.count(i); b++)
+                        if (p[a] == p[b])
+                            agree = false;
+                for (int j = 0; j < i; j++)
+                    if (paths.count(j) == paths.count(i) && std::equal(p, p + paths.count(i), paths.vertices(j)))
+                        agree = false;
+            }
+            graph::PathList parallel = graph::Paths::kShortest(g, 0, n - 1, k, 4);
+            for (int i = 0; i < paths.size(); i++)
+                if (parallel.size() != paths.size() || parallel.count(i) != paths.count(i) ||
+                    !std::equal(paths.vertices(i), paths.vertices(i) + paths.count(i), parallel.vertices(i)))
+                    deterministic = false;
+        }
+        CHECK(agree);
+        CHECK(deterministic);
+    }
+
+    SUBCASE("Grid alternatives and edge cases") {
+        graph::CSRGraph grid = graph::Generators::grid(100, 100, 0.0, 1, 9);
+        graph::PathList paths = graph::Paths::kShortest(grid, 0, 9999, 5);
+        long long scanned = graph::Instrumentation::lastCall().edgesScanned;
+        CHECK(paths.size() == 5);
+        // Spur searches on worker threads must still reach the caller's record.
+        graph::Paths::kShortest(grid, 0, 9999, 5, 4);
+        CHECK(graph::Instrumentation::lastCall().edgesScanned == scanned);
+        bool sorted = true;
+        for (int i = 1; i < paths.size(); i++)
+            if (paths.length(i) < paths.length(i - 1))
+                sorted = false;
+        CHECK(sorted);
+        graph::Graph g(4);
+        g.addEdge(0, 1, 2);
+        g.addEdge(2, 3, 1);
+        CHECK(graph::Paths::kShortest(g, 0, 3, 3).size() == 0);
+        graph::PathList self = graph::Paths::kShortest(g, 2, 2, 3);
+        CHECK(self.size() == 1);
+        CHECK(self.count(0) == 1);
+        CHECK(self.length(0) == 0);
+        CHECK(graph::Paths::kShortest(g, 0, 1, 0).size() == 0);
+        CHECK_THROWS(graph::Paths::kShortest(g, 0, 4, 1));
+        CHECK_THROWS(self.length(1));
+    }
+}
+
+TEST_CASE("Distance Table") {
+    graph::CSRGraph g = graph::Generators::rmat(10, 4, 0.57, 0.19, 0.19, 3, 20);
+    int n = g.getNumVertices();
+    int sources[40], targets[30];
+    for (int i = 0; i < 40; i++)
+        sources[i] = (i * 37) % n;
+    for (int j = 0; j < 30; j++)
+        targets[j] = (j * 101 + 5) % n;
+    targets[29] = targets[3];  // Duplicate target.
+    targets[28] = sources[7];  // A source is also a target.
+    long long* table = new long long[40 * 30];
+    long long* dist = new long long[n];
+    long long scanned[2];
+    for (int threads = 1; threads <= 4; threads += 3) {
+        graph::Paths::distanceTable(g, sources, 40, targets, 30, table, threads);
+        scanned[threads / 4] = graph::Instrumentation::lastCall().edgesScanned;
+        bool agree = true;
+        for (int i = 0; i < 40; i++) {
+            graph::SpMV::sssp(g, sources[i], dist, 1);
+            for (int j = 0; j < 30; j++) {
+                long long expected = dist[targets[j]];
+                if (expected == graph::MinPlusSemiring::zero())
+                    expected = graph::Paths::Unreachable;
+                if (table[i * 30 + j] != expected)
+                    agree = false;
+            }
+        }
+        CHECK(agree);
+    }
+    // Searches on worker threads must still reach the caller's record.
+    CHECK(scanned[0] == scanned[1]);
+    CHECK((scanned[0] > 0) == graph::Instrumentation::enabled());
+    graph::Graph small(3);
+    small.addEdge(0, 1, 4);
+    int from[] = {0, 2}, to[] = {1, 2, 0};
+    long long row[6];
+    graph::Paths::distanceTable(small, from, 2, to, 3, row, 2);
+    CHECK(row[0] == 4);
+    CHECK(row[1] == graph::Paths::Unreachable);
+    CHECK(row[2] == 0);
+    CHECK(row[3] == graph::Paths::Unreachable);
+    CHECK(row[4] == 0);
+    CHECK(row[5] == graph::Paths::Unreachable);
+    int bad[] = {3};
+    CHECK_THROWS(graph::Paths::distanceTable(small, bad, 1, to, 3, row));
+    delete[] table;
+    delete[] dist;
+}
+
+TEST_CASE("Floyd-Warshall") {
+    bool agree = true;
+    for (int trial = 0; trial < 4; trial++) {
+        int n = trial < 2 ? 150 : 64;
+        graph::CSRGraph g = graph::Generators::erdosRenyi(n, trial % 2 ? 120 : 600, 9 + trial, 50);
+        int* dist = new int[n * n];
+        int* all = new int[n];
+        for (int v = 0; v < n; v++)
+            all[v] = v;
+        long long* table = new long long[n * n];
+        graph::Paths::distanceTable(g, all, n, all, n, table, 1);
+        graph::Paths::floydWarshall(g, dist, trial % 2 ? 1 : 4);
+        for (int i = 0; i < n * n; i++) {
+            long long expected = table[i] == graph::Paths::Unreachable ? graph::MAX_INT_VALUE : table[i];
+            if (dist[i] != expected)
+                agree = false;
+        }
+        delete[] dist;
+        delete[] all;
+        delete[] table;
+    }
+    CHECK(agree);
+    graph::Graph g(3);
+    g.addEdge(0, 1, 1 << 29);
+    g.addEdge(1, 2, 1 << 29);
+    int dist[9];
+    CHECK_THROWS(graph::Paths::floydWarshall(g, dist));
+}
+
+TEST_CASE("Distances") {
+    bool exact = true, bounded = true, sampled = true, counted = true;
+    for (int trial = 0; trial < 4; trial++) {
+        graph::CSRGraph g = trial == 0 ? graph::Generators::grid(12, 30, 0.1, 3)
+                          : trial == 1 ? graph::Generators::erdosRenyi(400, 500, 5)
+                          : trial == 2 ? graph::Generators::kronecker(9, 4, 7)
+                                       : graph::Generators::grid(1, 200, 0.0, 1);
+        int n = g.getNumVertices();
+        // Exact eccentricities by BFS from every vertex.
+        int* level = new int[n];
+        int* ecc = new int[n];
+        double* pairs = new double[n + 1]();
+        for (int v = 0; v < n; v++) {
+            graph::SpMV::bfsLevels(g, v, level, 1);
+            ecc[v] = 0;
+            for (int w = 0; w < n; w++)
+                if (level[w] >= 0) {
+                    pairs[level[w]] += 1;
+                    if (level[w] > ecc[v])
+                        ecc[v] = level[w];
+                }
+        }
+        int root = 0;
+        for (int v = 1; v < n; v++)
+            if (g.degree(v) > g.degree(root))
+                root = v;
+        graph::SpMV::bfsLevels(g, root, level, 1);
+        int diameter = 0, longest = 0;
+        for (int v = 0; v < n; v++) {
+            if (level[v] >= 0 && ecc[v] > diameter)
+                diameter = ecc[v];
+            if (ecc[v] > longest)
+                longest = ecc[v];
+        }
+        int upper;
+        int lower = graph::Distances::diameter(g, &upper, 1 << 20, 2);
+        if (lower != diameter || upper != diameter)
+            exact = false;
+        for (int budget = 1; budget <= 8; budget++) {
+            lower = graph::Distances::diameter(g, &upper, budget, 1);
+            if (lower > diameter || upper < diameter)
+                bounded = false;
+        }
+        // Sampled bounds contain the exact eccentricities.
+        int* low = new int[n];
+        int* high = new int[n];
+        int pinned = graph::Distances::eccentricities(g, 8, low, high, 11, 2);
+        int count = 0;
+        for (int v = 0; v < n; v++) {
+            if (low[v] > ecc[v] || (high[v] >= 0 && high[v] < ecc[v]))
+                sampled = false;
+            if (low[v] == high[v])
+                count++;
+        }
+        if (pinned != count || pinned < 1)
+            sampled = false;
+        // HyperANF against the exact neighbourhood function.
+        double* nf = new double[n + 1];
+        int entries = graph::Distances::neighbourhoodFunction(g, nf, n, 8, 3, trial % 2 ? 1 : 4);
+        if (entries < 2 || entries > longest + 1)
+            counted = false;
+        double exactPairs = 0;
+        for (int t = 0; t < entries; t++) {
+            exactPairs += pairs[t];
+            if (std::fabs(nf[t] - exactPairs) > 0.1 * exactPairs || (t > 0 && nf[t] < nf[t - 1]))
+                counted = false;
+        }
+        delete[] level;
+        delete[] ecc;
+        delete[] pairs;
+        delete[] low;
+        delete[] high;
+        delete[] nf;
+    }
+    CHECK(exact);
+    CHECK(bounded);
+    CHECK(sampled);
+    CHECK(counted);
+
+    // Graph overloads on a path 0 - 1 - 2 - 3 - 4.
+    graph::Graph path(5);
+    for (int v = 0; v < 4; v++)
+        path.addEdge(v, v + 1, 1);
+    int upper;
+    CHECK(graph::Distances::diameter(path, &upper) == 4);
+    CHECK(upper == 4);
+    int low[5], high[5];
+    graph::Distances::eccentricities(path, 3, low, high, 1);
+    CHECK(low[2] <= 2);
+    CHECK(high[2] >= 2);
+    double nf[6];
+    CHECK(graph::Distances::neighbourhoodFunction(path, nf, 5, 10) <= 5);
+    double steps[] = {10, 30, 50, 70, 100};
+    CHECK(graph::Distances::effectiveDiameter(steps, 5, 0.5) == doctest::Approx(2));
+    CHECK(graph::Distances::effectiveDiameter(steps, 5, 0.85) == doctest::Approx(3.5));
+    CHECK(graph::Distances::effectiveDiameter(steps, 1) == 0);
+    CHECK_THROWS(graph::Distances::neighbourhoodFunction(path, nf, 5, 3));
+    CHECK_THROWS(graph::Distances::eccentricities(path, 0, low, high, 1));
+    CHECK_THROWS(graph::Distances::diameter(path, &upper, 0));
+}